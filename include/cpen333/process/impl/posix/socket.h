@@ -11,7 +11,14 @@
 #include <cstring>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <netdb.h>
+#include <algorithm>
+#include <climits>
+#include <cerrno>
+#include <vector>
 #include <arpa/inet.h>
 #include <unistd.h>
 
@@ -240,6 +247,74 @@ class socket {
     return true;
   }
 
+  /**
+   * @copydoc cpen333::process::windows::socket::write(const void* const*, const size_t*, size_t)
+   */
+  bool write(const void* const* buffs, const size_t* sizes, size_t count) {
+
+    if (!connected_) {
+      return false;
+    }
+
+    std::vector<struct iovec> iov;
+    iov.reserve(count);
+    for (size_t i=0; i<count; ++i) {
+      if (sizes[i] > 0) {
+        struct iovec v;
+        v.iov_base = const_cast<void*>(buffs[i]);
+        v.iov_len = sizes[i];
+        iov.push_back(v);
+      }
+    }
+
+    // write all contents, resuming part way through a buffer after a short write
+    size_t next = 0;
+    while (next < iov.size()) {
+      int n = (int)std::min<size_t>(iov.size()-next, IOV_MAX);
+      auto lwrite = ::writev(socket_, &iov[next], n);
+      if (lwrite == -1) {
+        if (errno == EINTR) {
+          continue;
+        }
+        cpen333::perror(std::string("writev(...) to socket failed"));
+        return false;
+      }
+      size_t nwrite = (size_t)lwrite;
+      while (next < iov.size() && nwrite >= iov[next].iov_len) {
+        nwrite -= iov[next].iov_len;
+        ++next;
+      }
+      if (nwrite > 0) {
+        iov[next].iov_base = (char*)iov[next].iov_base + nwrite;
+        iov[next].iov_len -= nwrite;
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * @copydoc cpen333::process::windows::socket::set_no_delay(bool)
+   */
+  bool set_no_delay(bool enable) {
+    int flag = enable ? 1 : 0;
+    return ::setsockopt(socket_, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag)) == 0;
+  }
+
+  /**
+   * @copydoc cpen333::process::windows::socket::set_cork(bool)
+   */
+  bool set_cork(bool enable) {
+    int flag = enable ? 1 : 0;
+#if defined(TCP_CORK)
+    return ::setsockopt(socket_, IPPROTO_TCP, TCP_CORK, &flag, sizeof(flag)) == 0;
+#elif defined(TCP_NOPUSH)
+    return ::setsockopt(socket_, IPPROTO_TCP, TCP_NOPUSH, &flag, sizeof(flag)) == 0;
+#else
+    return false;
+#endif
+  }
+
   /**
    * @copydoc cpen333::process::windows::socket::read(void*,size_t)
    */
@@ -299,6 +374,13 @@ class socket {
     return true;
   }
 
+  /**
+   * @copydoc cpen333::process::windows::socket::native_handle()
+   */
+  int native_handle() {
+    return socket_;
+  }
+
 };
 
 /**
@@ -312,6 +394,7 @@ class socket_server {
   int port_;
   int socket_;
   bool open_;
+  bool no_delay_;
 
  public:
 
@@ -319,7 +402,7 @@ class socket_server {
    * @copydoc cpen333::process::windows::socket_server::socket_server(int)
    */
   socket_server(int port = CPEN333_SOCKET_DEFAULT_PORT) :
-      port_(port), socket_(INVALID_SOCKET), open_(false) {}
+      port_(port), socket_(INVALID_SOCKET), open_(false), no_delay_(false) {}
 
  private:
   socket_server(const socket_server &) DELETE_METHOD;
@@ -424,10 +507,20 @@ class socket_server {
 
     client.close();
     client.__initialize("", -1, client_socket, true, true);
+    if (no_delay_) {
+      client.set_no_delay(true);
+    }
 
     return true;
   }
 
+  /**
+   * @copydoc cpen333::process::windows::socket_server::set_no_delay(bool)
+   */
+  void set_no_delay(bool enable) {
+    no_delay_ = enable;
+  }
+
   /**
    * @copydoc cpen333::process::windows::socket_server::close()
    */
@@ -449,6 +542,13 @@ class socket_server {
     return port_;
   }
 
+  /**
+   * @copydoc cpen333::process::windows::socket_server::native_handle()
+   */
+  int native_handle() {
+    return socket_;
+  }
+
   /**
    * @copydoc cpen333::process::windows::socket_server::address_lookup()
    */
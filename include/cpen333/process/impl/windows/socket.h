@@ -355,6 +355,58 @@ class socket {
     return true;
   }
 
+  /**
+   * @brief Sends several buffers through the socket as one contiguous stream
+   *
+   * Allows a message header and body to be sent without first copying them
+   * into a single buffer.  Where supported, the buffers are handed to the OS in
+   * a single call so they leave in as few packets as possible; otherwise they
+   * are sent one after the other.
+   *
+   * @param buffs pointers to the data buffers to send, in order
+   * @param sizes number of bytes to send from each buffer
+   * @param count number of buffers
+   * @return true if send successful, false otherwise
+   */
+  bool write(const void* const* buffs, const size_t* sizes, size_t count) {
+    for (size_t i=0; i<count; ++i) {
+      if (!write(buffs[i], sizes[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief Enables or disables Nagle's algorithm (TCP_NODELAY)
+   *
+   * With no-delay enabled, small writes are sent immediately instead of being
+   * held back while earlier data is unacknowledged.
+   *
+   * @param enable true to send small writes immediately
+   * @return true if the option was set, false otherwise
+   */
+  bool set_no_delay(bool enable) {
+    BOOL flag = enable ? TRUE : FALSE;
+    return ::setsockopt(socket_, IPPROTO_TCP, TCP_NODELAY, (const char*)&flag, sizeof(flag)) == 0;
+  }
+
+  /**
+   * @brief Enables or disables corking (TCP_CORK, or TCP_NOPUSH on BSD)
+   *
+   * While corked, partial packets are held back until a full packet can be
+   * sent, the socket is uncorked, or a short OS-defined timeout expires
+   * (200 ms on Linux).  Cork before a burst of writes and uncork right after,
+   * so the burst leaves in as few packets as possible without the last one
+   * waiting for the timeout.  Not supported by WinSock.
+   *
+   * @param enable true to hold back partial packets
+   * @return true if the option was set, false otherwise
+   */
+  bool set_cork(bool enable) {
+    return false;
+  }
+
   /**
    * @brief Receives bytes of data from a socket
    *
@@ -423,6 +475,18 @@ class socket {
     return true;
   }
 
+  /**
+   * @brief Native socket handle
+   *
+   * Allows the socket to be registered with OS-level event notification
+   * mechanisms.  The socket retains ownership of the handle.
+   *
+   * @return underlying socket handle, INVALID_SOCKET if not open
+   */
+  SOCKET native_handle() {
+    return socket_;
+  }
+
 };
 
 
@@ -437,6 +501,7 @@ class socket_server {
   int port_;
   SOCKET socket_;
   bool open_;
+  bool no_delay_;
   detail::WSASingleton& wsa_;
 
  private:
@@ -457,7 +522,7 @@ class socket_server {
    */
   socket_server(int port = CPEN333_SOCKET_DEFAULT_PORT) :
       port_(port), socket_(INVALID_SOCKET),
-      open_(false), wsa_(detail::WSASingleton::instance()) {
+      open_(false), no_delay_(false), wsa_(detail::WSASingleton::instance()) {
     wsa_.acquire();
   }
 
@@ -571,10 +636,22 @@ class socket_server {
 
     client.close();
     client.__initialize("", -1, client_socket, true, true);
+    if (no_delay_) {
+      client.set_no_delay(true);
+    }
 
     return true;
   }
 
+  /**
+   * @brief Sets whether accepted clients have Nagle's algorithm disabled
+   * @see socket::set_no_delay(bool)
+   * @param enable true to send small writes to clients immediately
+   */
+  void set_no_delay(bool enable) {
+    no_delay_ = enable;
+  }
+
   /**
    * @brief Close the server socket
    * @return true if successful, false otherwise
@@ -598,6 +675,14 @@ class socket_server {
     return port_;
   }
 
+  /**
+   * @brief Native listening socket handle
+   * @return underlying socket handle, INVALID_SOCKET if not open
+   */
+  SOCKET native_handle() {
+    return socket_;
+  }
+
   /**
    * @brief Looks up an address path based on the local host name
    * @return vector of addresses if found
@@ -0,0 +1,107 @@
+/**
+ * @file
+ *
+ * This contains the assignment engine that decides which waiting order a robot
+ * picks next.  Rather than taking whichever order is at the front of the pickup
+ * queue, a robot looking for work is given the order it can complete soonest:
+ * the one with the shortest trip from where the robot is, through the shelves
+ * holding the order's items, to the exit, counting an extra trip for each load
+ * the robot cannot carry at once.  The trip is priced in steps, plus
+ * ASSIGN_SLACK_WEIGHT steps for every tick the order has left before it is due.
+ * An order's price drops as it waits, so orders with long trips are still picked
+ * once they have waited long enough, and orders of more urgent service classes,
+ * due sooner, are priced lower than orders that came in with them.
+ *
+ * Several robots looking for work at once are matched to orders greedily in one
+ * batch, cheapest robot-order pair first.
+ *
+ */
+#ifndef PROJECT_ASSIGNMENT_ENGINE_H
+#define PROJECT_ASSIGNMENT_ENGINE_H
+
+#include "WarehouseCommon.h"
+#include "WarehouseObjects.h"
+#include "PathPlanner.h"
+#include "RouteOptimizer.h"
+#include "WavePlanner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#define ASSIGN_SLACK_WEIGHT 0.3   // steps added to an order's price for each tick before it is due
+
+/**
+ * What the assignment engine needs to know about a robot looking for work
+ */
+struct RobotState {
+	Coordinates position;   // where the robot is
+	double capacity;        // weight the robot can still carry
+};
+
+class AssignmentEngine {
+	RouteOptimizer optimizer_;
+	Coordinates exit_;
+
+public:
+	/**
+	* Constructor - assigns orders for robots finishing their trips at the exit
+	* @param planner path planner of the warehouse, must outlive the engine
+	* @param rinfo robot exit location
+	*/
+	AssignmentEngine(const PathPlanner& planner, const RobotInfo& rinfo) :
+		optimizer_(planner), exit_(rinfo.endx, rinfo.endy) {}
+
+	AssignmentEngine(const AssignmentEngine&) = delete;
+	AssignmentEngine& operator=(const AssignmentEngine&) = delete;
+
+	/**
+	* Estimated steps for a robot to complete an order
+	* @param robot robot to pick the order
+	* @param order shelves and weight of the order
+	* @return steps through the shelves to the exit, once per load the robot has to carry
+	*/
+	double cost(const RobotState& robot, const WaveOrder& order) const {
+		long steps = optimizer_.routeLength(robot.position, order.shelves,
+			optimizer_.plan(robot.position, order.shelves, exit_), exit_);
+		double loads = robot.capacity > 0 ? std::ceil(order.weight / robot.capacity) : 1;
+		return steps * std::max(1.0, loads);
+	}
+
+	/**
+	* Matches robots looking for work to waiting orders, cheapest pair first
+	* @param robots robots looking for work
+	* @param orders orders waiting to be picked
+	* @return for each robot, the index of its order, or -1 if there were too few orders
+	*/
+	std::vector<int> match(const std::vector<RobotState>& robots, const std::vector<WaveOrder>& orders) const {
+
+		std::vector<std::pair<double, std::pair<size_t, size_t>>> pairs;
+		for (size_t r = 0; r < robots.size(); r++) {
+			for (size_t o = 0; o < orders.size(); o++) {
+				double price = cost(robots[r], orders[o]) + ASSIGN_SLACK_WEIGHT * orders[o].slack;
+				pairs.push_back(std::make_pair(price, std::make_pair(r, o)));
+			}
+		}
+		std::sort(pairs.begin(), pairs.end());
+
+		std::vector<int> assigned(robots.size(), -1);
+		std::vector<bool> taken(orders.size(), false);
+		size_t matched = 0;
+		for (auto& pair : pairs) {
+			size_t r = pair.second.first;
+			size_t o = pair.second.second;
+			if (assigned[r] < 0 && !taken[o]) {
+				assigned[r] = (int)o;
+				taken[o] = true;
+				if (++matched == robots.size()) {
+					break;
+				}
+			}
+		}
+		return assigned;
+	}
+};
+
+#endif //PROJECT_ASSIGNMENT_ENGINE_H
@@ -0,0 +1,427 @@
+/**
+ * @file
+ *
+ * This file provides a compact binary encoding of messages, an alternative to the
+ * JSON encoding in JsonConverter.h that skips building and parsing a JSON document.
+ *
+ * Encoding format (all integers big endian):
+ *   message type (1 byte), request ID (int), followed by the fields of the message
+ *   in a fixed order
+ *     int     4 bytes, two's complement
+ *     double  8 bytes, IEEE 754 bit pattern
+ *     string  length (4 bytes), characters (no terminating zero)
+ *     entries count (4 bytes), then for each entry:
+ *             name (string), ID (int), price (double), quantity (int), weight (double)
+ *   Response messages start with status (string) and info (string).
+ *
+ * Decoding reads the fields straight out of the received bytes into the message
+ * objects, with every read bounds-checked so a truncated or corrupt payload is
+ * rejected instead of read past.
+ *
+ */
+
+#ifndef PROJECT_BINARY_CONVERTER_H
+#define PROJECT_BINARY_CONVERTER_H
+
+#include "Message.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Appends binary-encoded fields to a string
+ */
+class BinaryWriter {
+  std::string& out_;
+
+ public:
+  /**
+   * Constructor - appends to the given buffer
+   * @param out buffer to append to
+   */
+  BinaryWriter(std::string& out) : out_(out) {}
+
+  void writeByte(uint8_t value) {
+    out_.push_back((char)value);
+  }
+
+  void writeUInt(uint32_t value) {
+    char buff[4];
+    for (int i=4; i-->0;) {
+      buff[i] = (char)(value & 0xFF);
+      value = value >> 8;
+    }
+    out_.append(buff, 4);
+  }
+
+  void writeInt(int value) {
+    writeUInt((uint32_t)value);
+  }
+
+  void writeDouble(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    writeUInt((uint32_t)(bits >> 32));
+    writeUInt((uint32_t)(bits & 0xFFFFFFFF));
+  }
+
+  void writeString(const std::string& str) {
+    writeUInt((uint32_t)str.size());
+    out_.append(str);
+  }
+
+  void writeEntries(const std::vector<ItemEntry>& entries) {
+    writeUInt((uint32_t)entries.size());
+    for (const auto& entry : entries) {
+      writeString(entry.itemName);
+      writeInt(entry.ID);
+      writeDouble(entry.cost);
+      writeInt(entry.quantityAvailable);
+      writeDouble(entry.weight);
+    }
+  }
+};
+
+/**
+ * Reads binary-encoded fields from a buffer.  Once a read runs past the end of
+ * the buffer the reader is marked bad and every later read fails too.
+ */
+class BinaryReader {
+  const char* data_;
+  size_t size_;
+  size_t pos_;
+  bool good_;
+
+  /**
+   * Checks that a number of bytes remain, marking the reader bad otherwise
+   */
+  bool require(size_t n) {
+    if (good_ && size_ - pos_ < n) {
+      good_ = false;
+    }
+    return good_;
+  }
+
+ public:
+  /**
+   * Constructor - reads from a buffer that must outlive the reader
+   * @param data start of the encoded bytes
+   * @param size number of bytes
+   */
+  BinaryReader(const char* data, size_t size) : data_(data), size_(size), pos_(0), good_(true) {}
+
+  /**
+   * @return true if every read so far succeeded
+   */
+  bool good() const {
+    return good_;
+  }
+
+  /**
+   * @return true if every byte has been read
+   */
+  bool done() const {
+    return pos_ == size_;
+  }
+
+  bool readByte(uint8_t& value) {
+    if (!require(1)) {
+      return false;
+    }
+    value = (uint8_t)data_[pos_++];
+    return true;
+  }
+
+  bool readUInt(uint32_t& value) {
+    if (!require(4)) {
+      return false;
+    }
+    const unsigned char* buff = (const unsigned char*)&data_[pos_];
+    value = ((uint32_t)buff[0] << 24) | ((uint32_t)buff[1] << 16) | ((uint32_t)buff[2] << 8) | buff[3];
+    pos_ += 4;
+    return true;
+  }
+
+  bool readInt(int& value) {
+    uint32_t bits = 0;
+    if (!readUInt(bits)) {
+      return false;
+    }
+    value = (int)bits;
+    return true;
+  }
+
+  bool readDouble(double& value) {
+    uint32_t high = 0;
+    uint32_t low = 0;
+    if (!readUInt(high) || !readUInt(low)) {
+      return false;
+    }
+    uint64_t bits = ((uint64_t)high << 32) | low;
+    std::memcpy(&value, &bits, sizeof(value));
+    return true;
+  }
+
+  bool readString(std::string& str) {
+    uint32_t length = 0;
+    if (!readUInt(length) || !require(length)) {
+      return false;
+    }
+    str.assign(&data_[pos_], length);
+    pos_ += length;
+    return true;
+  }
+
+  // unknown: if given, names come from a client and are looked up rather than
+  // interned, an unknown one is left empty and the first recorded in *unknown
+  bool readEntries(std::vector<ItemEntry>& entries, std::string* unknown = nullptr) {
+    uint32_t count = 0;
+    if (!readUInt(count)) {
+      return false;
+    }
+    // every entry takes at least 28 bytes, don't trust a count the payload can't hold
+    if (!require((size_t)count * 28)) {
+      return false;
+    }
+    entries.reserve(count);
+    // names are interned, so one buffer does for all of them
+    std::string name;
+    for (uint32_t i = 0; i < count; i++) {
+      int ID = 0;
+      double cost = 0;
+      int quantity = 0;
+      double weight = 0;
+      if (!readString(name) || !readInt(ID) || !readDouble(cost) || !readInt(quantity) || !readDouble(weight)) {
+        return false;
+      }
+      InternedString iname;
+      if (unknown == nullptr) {
+        iname = InternedString(name);
+      }
+      else if (!InternedString::find(name, iname) && unknown->empty()) {
+        *unknown = name;
+      }
+      entries.push_back(ItemEntry(iname, quantity, ID, weight, 0));
+      entries.back().cost = cost;
+    }
+    return true;
+  }
+};
+
+/**
+ * Handles all conversions to and from the binary encoding
+ */
+class BinaryConverter {
+ public:
+  /**
+   * Appends the binary encoding of a message to a buffer
+   * @param msg message to encode
+   * @param out buffer to append to
+   */
+  static void encode(const Message& msg, std::string& out) {
+    BinaryWriter writer(out);
+    writer.writeByte((uint8_t)msg.type());
+    writer.writeInt(msg.requestId);
+
+    switch(msg.type()) {
+      case ADD: {
+        const AddMessage& add = (const AddMessage&) msg;
+        writer.writeString(add.itemName);
+        writer.writeInt(add.itemID);
+        writer.writeInt(add.itemQuantity);
+        break;
+      }
+      case ADD_RESPONSE: {
+        const AddResponseMessage& add_response = (const AddResponseMessage&) msg;
+        writer.writeString(add_response.status);
+        writer.writeString(add_response.info);
+        writer.writeEntries(add_response.results);
+        break;
+      }
+      case SEARCH: {
+        const SearchMessage& search = (const SearchMessage&) msg;
+        writer.writeString(search.itemName);
+        writer.writeInt(search.itemID);
+        break;
+      }
+      case SEARCH_RESPONSE: {
+        const SearchResponseMessage& search_response = (const SearchResponseMessage&) msg;
+        writer.writeString(search_response.status);
+        writer.writeString(search_response.info);
+        writer.writeEntries(search_response.results);
+        break;
+      }
+      case CONFIRM_ORDER: {
+        const ConfirmOrder& confirm = (const ConfirmOrder&) msg;
+        writer.writeEntries(confirm.order);
+        writer.writeString(confirm.sla);
+        break;
+      }
+      case CONFIRM_ORDER_RESPONSE: {
+        const ConfirmOrderResponseMessage& confirm_response = (const ConfirmOrderResponseMessage&) msg;
+        writer.writeString(confirm_response.status);
+        writer.writeString(confirm_response.info);
+        writer.writeInt(confirm_response.orderNum);
+        break;
+      }
+      case CANCEL_ORDER: {
+        const CancelOrder& cancel = (const CancelOrder&) msg;
+        writer.writeInt(cancel.orderNum);
+        break;
+      }
+      case BATCH_ADD: {
+        const BatchAddMessage& batch = (const BatchAddMessage&) msg;
+        writer.writeEntries(batch.items);
+        break;
+      }
+      case BATCH_ADD_RESPONSE: {
+        const BatchAddResponseMessage& batch_response = (const BatchAddResponseMessage&) msg;
+        writer.writeString(batch_response.status);
+        writer.writeString(batch_response.info);
+        writer.writeEntries(batch_response.results);
+        break;
+      }
+      case CANCEL_ORDER_RESPONSE:
+      case BUSY_RESPONSE: {
+        const ResponseMessage& response = (const ResponseMessage&) msg;
+        writer.writeString(response.status);
+        writer.writeString(response.info);
+        break;
+      }
+      default: {
+        // GOODBYE has no fields, anything else is sent as its bare type and
+        // rejected by the receiver
+      }
+    }
+  }
+
+  /**
+   * Decodes a message from its binary encoding
+   * @param data start of the encoded message
+   * @param size number of bytes
+   * @return decoded message, or nullptr if invalid
+   */
+  static std::unique_ptr<Message> decode(const char* data, size_t size) {
+    BinaryReader reader(data, size);
+    std::unique_ptr<Message> out;
+
+    uint8_t type = 0;
+    int requestId = 0;
+    if (!reader.readByte(type) || !reader.readInt(requestId)) {
+      return out;
+    }
+
+    switch(type) {
+      case ADD: {
+        std::string name;
+        int ID = 0;
+        int quantity = 0;
+        if (reader.readString(name) && reader.readInt(ID) && reader.readInt(quantity)) {
+          out.reset(new AddMessage(std::move(name), ID, quantity));
+        }
+        break;
+      }
+      case ADD_RESPONSE: {
+        std::string status, info;
+        std::vector<ItemEntry> results;
+        if (reader.readString(status) && reader.readString(info) && reader.readEntries(results)) {
+          out.reset(new AddResponseMessage(std::move(results), status, info));
+        }
+        break;
+      }
+      case SEARCH: {
+        std::string name;
+        int ID = 0;
+        if (reader.readString(name) && reader.readInt(ID)) {
+          out.reset(new SearchMessage(std::move(name), ID));
+        }
+        break;
+      }
+      case SEARCH_RESPONSE: {
+        std::string status, info;
+        std::vector<ItemEntry> results;
+        if (reader.readString(status) && reader.readString(info) && reader.readEntries(results)) {
+          out.reset(new SearchResponseMessage(std::move(results), status, info));
+        }
+        break;
+      }
+      case CONFIRM_ORDER: {
+        std::vector<ItemEntry> order;
+        std::string sla, unknown;
+        if (reader.readEntries(order, &unknown) && reader.readString(sla)) {
+          ConfirmOrder* confirm = new ConfirmOrder(std::move(order), sla);
+          confirm->unknownItem = std::move(unknown);
+          out.reset(confirm);
+        }
+        break;
+      }
+      case CONFIRM_ORDER_RESPONSE: {
+        std::string status, info;
+        int num = 0;
+        if (reader.readString(status) && reader.readString(info) && reader.readInt(num)) {
+          out.reset(new ConfirmOrderResponseMessage(num, status, info));
+        }
+        break;
+      }
+      case CANCEL_ORDER: {
+        int num = 0;
+        if (reader.readInt(num)) {
+          out.reset(new CancelOrder(num));
+        }
+        break;
+      }
+      case CANCEL_ORDER_RESPONSE: {
+        std::string status, info;
+        if (reader.readString(status) && reader.readString(info)) {
+          out.reset(new CancelOrderResponseMessage(status, info));
+        }
+        break;
+      }
+      case BUSY_RESPONSE: {
+        std::string status, info;
+        if (reader.readString(status) && reader.readString(info)) {
+          out.reset(new BusyResponseMessage(info));
+        }
+        break;
+      }
+      case BATCH_ADD: {
+        std::vector<ItemEntry> items;
+        std::string unknown;
+        if (reader.readEntries(items, &unknown)) {
+          BatchAddMessage* batch = new BatchAddMessage(std::move(items));
+          batch->unknownItem = std::move(unknown);
+          out.reset(batch);
+        }
+        break;
+      }
+      case BATCH_ADD_RESPONSE: {
+        std::string status, info;
+        std::vector<ItemEntry> results;
+        if (reader.readString(status) && reader.readString(info) && reader.readEntries(results)) {
+          out.reset(new BatchAddResponseMessage(std::move(results), status, info));
+        }
+        break;
+      }
+      case GOODBYE: {
+        out.reset(new GoodbyeMessage());
+        break;
+      }
+      default: {
+      }
+    }
+
+    // trailing bytes mean the sender used a different layout
+    if (out != nullptr && !reader.done()) {
+      out.reset();
+    }
+    if (out != nullptr) {
+      out->requestId = requestId;
+    }
+    return out;
+  }
+};
+
+#endif //PROJECT_BINARY_CONVERTER_H
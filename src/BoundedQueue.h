@@ -0,0 +1,116 @@
+/**
+ * @file
+ *
+ * This contains a fixed-capacity multi-producer multi-consumer queue.  Producers can
+ * either block until there is room or give up immediately when the queue is full,
+ * which is what lets the server push back on clients instead of queueing work
+ * without limit.
+ *
+ */
+#ifndef PROJECT_BOUNDED_QUEUE_H
+#define PROJECT_BOUNDED_QUEUE_H
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+template<typename T>
+class BoundedQueue {
+	std::deque<T> queue_;
+	size_t capacity_;
+	bool closed_;
+	std::mutex mutex_;
+	std::condition_variable notEmpty_;
+	std::condition_variable notFull_;
+
+public:
+	/**
+	* Constructor - creates an empty queue
+	* @param capacity maximum number of queued elements
+	*/
+	BoundedQueue(size_t capacity) : queue_(), capacity_(capacity), closed_(false), mutex_(), notEmpty_(), notFull_() {}
+
+	/**
+	* Adds an element if there is room, without waiting
+	* @param value element to add
+	* @return true if added, false if the queue is full or closed
+	*/
+	bool try_push(T&& value) {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (closed_ || queue_.size() >= capacity_) {
+				return false;
+			}
+			queue_.push_back(std::move(value));
+		}
+		notEmpty_.notify_one();
+		return true;
+	}
+
+	/**
+	* Adds an element, waiting for room if the queue is full
+	* @param value element to add
+	* @return true if added, false if the queue was closed
+	*/
+	bool push(T&& value) {
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			notFull_.wait(lock, [this] { return closed_ || queue_.size() < capacity_; });
+			if (closed_) {
+				return false;
+			}
+			queue_.push_back(std::move(value));
+		}
+		notEmpty_.notify_one();
+		return true;
+	}
+
+	/**
+	* Removes the oldest element, waiting for one if the queue is empty
+	* @param value populated with the removed element
+	* @return true if an element was removed, false if the queue is closed and empty
+	*/
+	bool pop(T& value) {
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			notEmpty_.wait(lock, [this] { return closed_ || !queue_.empty(); });
+			if (queue_.empty()) {
+				return false;
+			}
+			value = std::move(queue_.front());
+			queue_.pop_front();
+		}
+		notFull_.notify_one();
+		return true;
+	}
+
+	/**
+	* Stops accepting elements and wakes up all waiting threads.  Elements
+	* already queued can still be removed.
+	*/
+	void close() {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			closed_ = true;
+		}
+		notEmpty_.notify_all();
+		notFull_.notify_all();
+	}
+
+	/**
+	* Number of queued elements
+	*/
+	size_t size() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return queue_.size();
+	}
+
+	/**
+	* Maximum number of queued elements
+	*/
+	size_t capacity() const {
+		return capacity_;
+	}
+};
+
+#endif //PROJECT_BOUNDED_QUEUE_H
@@ -0,0 +1,108 @@
+/**
+ * @file
+ *
+ * This contains the index of free weight capacity on each shelf.  Shelves keep it
+ * up to date as items are stored on and released from them.  Shelves are kept
+ * ordered by free capacity, so finding the shelf that fits a weight most tightly
+ * (best fit) takes logarithmic time, and a placement either finds a shelf at once
+ * or knows at once that none has room.
+ *
+ */
+#ifndef PROJECT_CAPACITY_INDEX_H
+#define PROJECT_CAPACITY_INDEX_H
+
+#include <set>
+#include <utility>
+#include <vector>
+
+#define CAPACITY_HISTOGRAM_BINS 4   // fill ratio bins reported, e.g. 4 for quarters
+
+/**
+ * How full the shelves are
+ */
+struct CapacityStats {
+	int shelves;
+	int emptyShelves;
+	double capacity;      // total weight the shelves can hold
+	double used;          // total weight on the shelves
+	double fillRatio;     // used / capacity
+	int histogram[CAPACITY_HISTOGRAM_BINS];   // shelves by fill ratio, lowest bin first
+};
+
+class CapacityIndex {
+	double shelfCapacity_;
+	std::set<std::pair<double, int>> byFree_;   // (free capacity, shelf), least free first
+	std::vector<double> free_;                  // free capacity of each shelf, -1 if not indexed
+
+public:
+	/**
+	* Constructor - creates an empty index
+	* @param shelfCapacity weight each shelf can hold
+	*/
+	CapacityIndex(double shelfCapacity) : shelfCapacity_(shelfCapacity), byFree_(), free_() {}
+
+	/**
+	* Records a shelf's free capacity
+	* @param shelf index of the shelf in the warehouse
+	* @param freeCapacity weight the shelf can still take
+	*/
+	void update(int shelf, double freeCapacity) {
+		if ((size_t)shelf >= free_.size()) {
+			free_.resize(shelf + 1, -1);
+		}
+		if (free_[shelf] >= 0) {
+			byFree_.erase(std::make_pair(free_[shelf], shelf));
+		}
+		free_[shelf] = freeCapacity;
+		byFree_.insert(std::make_pair(freeCapacity, shelf));
+	}
+
+	/**
+	* Finds the shelf with the least free capacity that still fits a weight
+	* @param weight weight to fit
+	* @return index of the shelf, -1 if no shelf has room
+	*/
+	int bestFit(double weight) const {
+		auto it = byFree_.lower_bound(std::make_pair(weight, -1));
+		return it == byFree_.end() ? -1 : it->second;
+	}
+
+	/**
+	* @return free capacity of the emptiest shelf, 0 if there are none
+	*/
+	double mostFree() const {
+		return byFree_.empty() ? 0 : byFree_.rbegin()->first;
+	}
+
+	/**
+	* @return how full the shelves are
+	*/
+	CapacityStats stats() const {
+		CapacityStats stats = {};
+		for (auto& shelf : byFree_) {
+			double used = shelfCapacity_ - shelf.first;
+			double ratio = shelfCapacity_ > 0 ? used / shelfCapacity_ : 1;
+			int bin = (int)(ratio * CAPACITY_HISTOGRAM_BINS);
+			bin = bin < 0 ? 0 : (bin >= CAPACITY_HISTOGRAM_BINS ? CAPACITY_HISTOGRAM_BINS - 1 : bin);
+			stats.shelves++;
+			stats.capacity += shelfCapacity_;
+			stats.used += used;
+			stats.histogram[bin]++;
+			if (used <= 0) {
+				stats.emptyShelves++;
+			}
+		}
+		stats.fillRatio = stats.capacity > 0 ? stats.used / stats.capacity : 0;
+		return stats;
+	}
+
+	/**
+	* Forgets all shelves
+	*/
+	void clear() {
+		byFree_.clear();
+		free_.clear();
+	}
+};
+
+#endif //PROJECT_CAPACITY_INDEX_H
@@ -4,49 +4,41 @@
 #include <iostream>
 #include <vector>
 #include <string>
-#include <deque>
-#include <mutex>
+#include <utility>
 #include "WarehouseObjects.h"
+#include "MpmcQueue.h"
+
+#define DELIVERY_COMP_QUEUE_CAPACITY 1024   // most picked orders waiting for a delivery truck
 
 class DeliveryCompQueue {
-	std::deque<Order> deliveryCompQueue; 
-	std::mutex mutex_;
-	std::condition_variable cv_;
+	MpmcQueue<Order> deliveryCompQueue; 
 
 
 public:
 	/**
 	* Constructor- creates a new delivery queue
 	*/
-	DeliveryCompQueue() : deliveryCompQueue(), mutex_(), cv_() {}
+	DeliveryCompQueue() : deliveryCompQueue(DELIVERY_COMP_QUEUE_CAPACITY) {}
 
 	/**
-	* Adds to delivery queue
-	* @param Order, picked order to be added to delivery queue by robots 
+	* Adds to delivery queue, waiting for room if it is full
+	* @param order, picked order to be added to delivery queue by robots 
 	*/
-	void addToDCQueue(Order Order)
+	void addToDCQueue(Order order)
 	{
-		mutex_.lock();
-		deliveryCompQueue.push_back(Order);
-		mutex_.unlock();
-		cv_.notify_one();
+		deliveryCompQueue.push(std::move(order));
 	}
 
 	/**
-	* Removes an order from the delivery queue
+	* Removes an order from the delivery queue, waiting for one if it is empty
 	* @return next order in queue to be moved to truck delivery queue
 	*/
 	Order removeFromDCQueue(void) 
 	{
-		std::unique_lock <std::mutex> lock(mutex_);
-		cv_.wait(lock, [this] {return !deliveryCompQueue.empty(); });
-		// get first item in queue
-		Order command = deliveryCompQueue.front(); 
-		deliveryCompQueue.pop_front();
-		lock.unlock();
-
+		Order command;
+		deliveryCompQueue.pop(command);
 		return command;
 	}
 };
 
-#endif //PROJECT__DELIVERYCOMPQUEUE 
\ No newline at end of file
+#endif //PROJECT__DELIVERYCOMPQUEUE
\ No newline at end of file
@@ -4,10 +4,13 @@
 #include <iostream>
 #include <vector>
 #include <string>
-#include <deque>
-#include <mutex>
-#include <cpen333\thread\semaphore.h>
+#include <atomic>
+#include <utility>
 #include "WarehouseObjects.h"
+#include "WorkSignal.h"
+#include "MpmcQueue.h"
+
+#define DELIVERY_TRUCK_QUEUE_CAPACITY 1024   // most picked orders waiting to be loaded onto trucks
 
 
 class tCommand {
@@ -21,63 +24,72 @@ public:
 	* @param list, order for robot to deliver
 	* @param number, truck number to deliver to 
 	*/
-	tCommand(Order list, int number) : order(list), loadingDockNumber(number) {}
+	tCommand(Order list, int number) : order(std::move(list)), loadingDockNumber(number) {}
 
 	int getDockNumber() {
 		return loadingDockNumber;
 	}
 
-	Order getOrder() {
+	/**
+	* @return the order to deliver, move it out to take it without copying
+	*/
+	Order& getOrder() {
 		return order;
 	}
 };
 
 class DeliveryTruckQueue {
-	std::deque<tCommand> deliveryTruckQueue; 
-	std::mutex mutex_;
-	cpen333::thread::semaphore delTSemaphore;
+	MpmcQueue<tCommand> deliveryTruckQueue; 
+	std::atomic<WorkSignal*> signal_;
 
 
 public:
 	/**
 	* Constructor- creates a new delivery queue
 	*/
-	DeliveryTruckQueue() : deliveryTruckQueue(), mutex_(), delTSemaphore(0) {}
+	DeliveryTruckQueue() : deliveryTruckQueue(DELIVERY_TRUCK_QUEUE_CAPACITY), signal_(nullptr) {}
 
 	/**
-	* Adds to delivery queue
-	* @param Order, picked order to be added to delivery queue
+	* Posts to a signal whenever a command is added
+	* @param signal signal shared with the other robot work queues
+	*/
+	void attach(WorkSignal& signal) {
+		signal_ = &signal;
+	}
+
+	/**
+	* Adds to delivery queue, waiting for room if it is full
+	* @param command, picked order to be added to delivery queue, and its dock
 	*/
 	void addToDTQueue(tCommand command)
 	{
-		mutex_.lock();
-		deliveryTruckQueue.push_back(command);
-		mutex_.unlock();
-		delTSemaphore.notify();
+		deliveryTruckQueue.push(std::move(command));
+		WorkSignal* signal = signal_;
+		if (signal != nullptr) {
+			signal->post();
+		}
+	}
+
+	/**
+	* Removes an order from the delivery queue without waiting
+	* @param command populated with the next command in queue
+	* @return true if there was a command
+	*/
+	bool tryRemoveFromDTQueue(tCommand& command)
+	{
+		return deliveryTruckQueue.try_pop(command);
 	}
 
 	/**
 	* Removes an order from the delivery queue
-	* @return next order in queue to be delivered to trucks by robots
+	* @return next order in queue to be delivered to trucks by robots, dock -1 if there is none
 	*/
 	tCommand removeFromDTQueue(void) 
 	{
 		tCommand command(Order(-1),-1);
-		std::unique_lock <std::mutex> lock(mutex_);
-		bool success = delTSemaphore.try_wait();
-		if (success) {
-			// get first item in queue
-			command = deliveryTruckQueue.front();
-			deliveryTruckQueue.pop_front();
-
-		}
-		else {
-			
-		}
-		lock.unlock();
-
+		deliveryTruckQueue.try_pop(command);
 		return command;
 	}
 };
 
-#endif //PROJECT__DELIVERYTRUCKQUEUE 
\ No newline at end of file
+#endif //PROJECT__DELIVERYTRUCKQUEUE
\ No newline at end of file
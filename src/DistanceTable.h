@@ -0,0 +1,176 @@
+/**
+ * @file
+ *
+ * This contains the table of distances between the warehouse's points of
+ * interest: every shelf, every dock, the robots' start and the exit.
+ *
+ * The warehouse computer fills it in once at startup, after the layout is loaded,
+ * and keeps it in shared memory beside SharedData so every process can look up
+ * the number of steps between two points in constant time without planning.
+ *
+ * Layout in shared memory:
+ *   DistanceInfo (fixed size): which cell each point of interest is in, and the
+ *       point of interest of each cell
+ *   distance matrix (sized for the layout): steps between every pair of points, as
+ *       16-bit counts.  Distances are symmetric, so only pairs i < j are stored,
+ *       row by row: pair (i, j) is at j*(j-1)/2 + i.
+ *
+ */
+#ifndef PROJECT_DISTANCE_TABLE_H
+#define PROJECT_DISTANCE_TABLE_H
+
+#include <cpen333/process/shared_memory.h>
+
+#include "WarehouseCommon.h"
+#include "WarehouseObjects.h"
+#include "PathPlanner.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#define DISTANCE_MEMORY_NAME "Amazoom_Warehouse_distances"
+#define DISTANCE_MATRIX_NAME "Amazoom_Warehouse_distance_matrix"
+#define MAX_POINTS (MAX_WAREHOUSE_SIZE*MAX_WAREHOUSE_SIZE)
+
+struct DistanceInfo {
+	int npoints;                                             // points of interest
+	int16_t point[MAX_WAREHOUSE_SIZE][MAX_WAREHOUSE_SIZE];   // point in each [col][row], -1 if none
+	int ploc[MAX_POINTS][2];                                 // cell of each point
+	int magic;                                               // MAGIC_NUMBER once filled in
+};
+
+/**
+ * Reads and writes the shared distance table
+ */
+class DistanceTable {
+	cpen333::process::shared_object<DistanceInfo> info_;
+	std::unique_ptr<cpen333::process::shared_memory> matrix_;
+	uint16_t* dist_;
+
+	static size_t pairs(int npoints) {
+		return (size_t)npoints * (npoints - 1) / 2;
+	}
+
+	/**
+	* Maps the matrix for the current number of points.  The count is part of the
+	* name, so a table left over from a different layout is never mapped at the
+	* wrong size.
+	*/
+	void openMatrix() {
+		int npoints = info_->npoints;
+		size_t bytes = std::max(pairs(npoints), (size_t)1) * sizeof(uint16_t);
+		matrix_.reset(new cpen333::process::shared_memory(
+			DISTANCE_MATRIX_NAME + std::to_string(npoints), bytes));
+		dist_ = (uint16_t*)matrix_->get();
+	}
+
+	void addPoint(int row, int col) {
+		int p = info_->npoints++;
+		info_->point[col][row] = (int16_t)p;
+		info_->ploc[p][COL_IDX] = col;
+		info_->ploc[p][ROW_IDX] = row;
+	}
+
+public:
+	/**
+	* Constructor - opens the shared table, which may not be filled in yet
+	*/
+	DistanceTable() : info_(DISTANCE_MEMORY_NAME), matrix_(), dist_(nullptr) {}
+
+	/**
+	* Fills in the table for a layout, replacing any earlier one
+	* @param planner path planner of the layout
+	* @param winfo warehouse layout
+	* @param rinfo robot start and exit locations
+	*/
+	void build(const PathPlanner& planner, const WarehouseInfo& winfo, const RobotInfo& rinfo) {
+		info_->magic = 0;
+		info_->npoints = 0;
+		for (int c = 0; c < MAX_WAREHOUSE_SIZE; c++) {
+			for (int r = 0; r < MAX_WAREHOUSE_SIZE; r++) {
+				info_->point[c][r] = -1;
+			}
+		}
+
+		for (int r = 0; r < winfo.rows; r++) {
+			for (int c = 0; c < winfo.cols; c++) {
+				if (winfo.maze[c][r] == SHELF_CHAR || winfo.maze[c][r] == DOCK_CHAR) {
+					addPoint(r, c);
+				}
+			}
+		}
+		addPoint(rinfo.startx, rinfo.starty);
+		addPoint(rinfo.endx, rinfo.endy);
+
+		openMatrix();
+		int npoints = info_->npoints;
+		for (int j = 1; j < npoints; j++) {
+			Coordinates b(info_->ploc[j][ROW_IDX], info_->ploc[j][COL_IDX]);
+			uint16_t* row = dist_ + (size_t)j * (j - 1) / 2;
+			for (int i = 0; i < j; i++) {
+				Coordinates a(info_->ploc[i][ROW_IDX], info_->ploc[i][COL_IDX]);
+				row[i] = (uint16_t)planner.distanceBetween(a, b);
+			}
+		}
+		info_->magic = MAGIC_NUMBER;
+	}
+
+	/**
+	* Checks whether the table has been filled in, mapping it if it has
+	* @return true if distances can be looked up
+	*/
+	bool ready() {
+		if (info_->magic != MAGIC_NUMBER) {
+			return false;
+		}
+		if (dist_ == nullptr) {
+			openMatrix();
+		}
+		return true;
+	}
+
+	/**
+	* @return number of points of interest
+	*/
+	int points() {
+		return info_->npoints;
+	}
+
+	/**
+	* Steps between two points of interest, from whichever cells next to them are
+	* closest.  Only call once ready() is true.
+	* @param a shelf, dock, start or exit
+	* @param b shelf, dock, start or exit
+	* @return steps between them, PATH_UNREACHABLE if there is no route or either is
+	*         not a point of interest
+	*/
+	int distance(const Coordinates& a, const Coordinates& b) {
+		if (a.XCoordinates < 0 || a.XCoordinates >= MAX_WAREHOUSE_SIZE || a.YCoordinates < 0 || a.YCoordinates >= MAX_WAREHOUSE_SIZE ||
+			b.XCoordinates < 0 || b.XCoordinates >= MAX_WAREHOUSE_SIZE || b.YCoordinates < 0 || b.YCoordinates >= MAX_WAREHOUSE_SIZE) {
+			return PATH_UNREACHABLE;
+		}
+		int i = info_->point[a.YCoordinates][a.XCoordinates];
+		int j = info_->point[b.YCoordinates][b.XCoordinates];
+		if (i < 0 || j < 0) {
+			return PATH_UNREACHABLE;
+		}
+		if (i == j) {
+			return 0;
+		}
+		if (i > j) {
+			std::swap(i, j);
+		}
+		return dist_[(size_t)j * (j - 1) / 2 + i];
+	}
+
+	/**
+	* @return bytes of shared memory used by the table
+	*/
+	size_t bytes() {
+		return sizeof(DistanceInfo) + pairs(info_->npoints) * sizeof(uint16_t);
+	}
+};
+
+#endif //PROJECT_DISTANCE_TABLE_H
@@ -0,0 +1,537 @@
+/**
+ * @file
+ *
+ * This contains an event-driven alternative to spawning one thread per client.  A
+ * small fixed pool of reactor threads each own an epoll instance.  Accepted client
+ * sockets are made non-blocking and handed to the reactors round-robin.  A reactor
+ * reads whatever bytes are available, reassembles frames per connection, and hands
+ * every complete message to the server's handler.  The handler may reply right away
+ * or later from another thread (e.g. a worker pool); replies are passed back to the
+ * connection's reactor, queued per connection and flushed as the socket accepts them.
+ *
+ * A client can't make the server buffer its requests without limit: a connection
+ * with too many requests awaiting replies, or too many replies it has not taken,
+ * is no longer read until they drain, leaving the rest in the socket for TCP to
+ * push back on the client.
+ *
+ * Only available on Linux, since it relies on epoll.
+ *
+ */
+#ifndef PROJECT_EVENT_LOOP_SERVER_H
+#define PROJECT_EVENT_LOOP_SERVER_H
+
+// default number of reactor threads
+#define EVENT_LOOP_THREADS 4
+// bytes requested from the socket per read call
+#define EVENT_LOOP_READ_SIZE 65536
+// maximum events processed per epoll_wait call
+#define EVENT_LOOP_MAX_EVENTS 64
+// bytes read from a connection in one pass before its frames are serviced
+#define EVENT_LOOP_MAX_BUFFERED (1024*1024)
+// requests per connection awaiting replies before its input stops being read
+#define EVENT_LOOP_MAX_INFLIGHT 64
+// bytes of replies the client has not taken before its input stops being read
+#define EVENT_LOOP_MAX_UNSENT (1024*1024)
+
+#ifdef __linux__
+
+#include "Message.h"
+#include "FrameBuffer.h"
+#include "JsonUserClientApi.h"
+
+#include <cpen333/process/socket.h>
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include <atomic>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class EventLoopServer {
+public:
+	/**
+	* Sends a response back to the client a message came from.  May be called
+	* from any thread, and must be called exactly once per message; nullptr sends
+	* nothing but still tells the connection the message has been dealt with.
+	*/
+	typedef std::function<void(std::unique_ptr<Message> response)> Reply;
+
+	/**
+	* Reacts to a message from a client
+	* @param msg received message
+	* @param id client id for printing messages to the console
+	* @param reply function to pass the response to
+	*/
+	typedef std::function<void(std::unique_ptr<Message>&& msg, int id, Reply reply)> Handler;
+
+private:
+	/**
+	* State of a single client connection, owned by one reactor
+	*/
+	struct Connection {
+		cpen333::process::socket socket;
+		int id;
+		FrameBuffer input;
+		std::string output;      // encoded responses not yet accepted by the socket
+		size_t outputStart;
+		bool writing;            // registered for EPOLLOUT
+		bool closing;            // no more requests are read, close once every reply is flushed
+		bool eof;                // the client shut down its side, only buffered requests are left
+		size_t inflight;         // messages handed to the handler whose replies have not come back
+		uint32_t events;         // events registered with epoll
+
+		Connection(cpen333::process::socket&& socket, int id) :
+			socket(std::move(socket)), id(id), input(), output(), outputStart(0), writing(false), closing(false),
+			eof(false), inflight(0), events(EPOLLIN | EPOLLRDHUP) {}
+
+		/**
+		* @return true while the client has too many requests awaiting replies, or
+		*         replies not yet sent, for more of its requests to be serviced
+		*/
+		bool backlogged() const {
+			return inflight >= EVENT_LOOP_MAX_INFLIGHT || output.size() - outputStart >= EVENT_LOOP_MAX_UNSENT;
+		}
+
+		/**
+		* @return true if requests are to be read, false once the client is done or
+		*         while it is backlogged
+		*/
+		bool reading() const {
+			return !closing && !eof && !backlogged();
+		}
+
+		/**
+		* @return true once a closing connection has nothing left to send
+		*/
+		bool finished() const {
+			return closing && inflight == 0 && !writing;
+		}
+	};
+
+	/**
+	* One event loop thread and its epoll instance
+	*/
+	struct Reactor {
+		int epoll;
+		int wakeup;              // eventfd used to interrupt epoll_wait for replies and stop()
+		std::thread thread;
+
+		// connections registered with this reactor, only touched by its thread
+		std::unordered_map<Connection*, std::shared_ptr<Connection>> connections;
+
+		// handed over by other threads, guarded by mutex
+		std::mutex mutex;
+		std::vector<std::shared_ptr<Connection>> incoming;   // accepted, not yet registered
+		std::vector<std::pair<std::weak_ptr<Connection>, std::string>> replies;  // encoded responses, empty if none
+	};
+
+	Handler handler_;
+	bool cork_;              // cork a connection while its pending output is written
+	std::vector<std::unique_ptr<Reactor>> reactors_;
+	std::atomic<bool> running_;
+	size_t next_;
+
+	/**
+	* Writes as much pending output as the socket accepts, then registers for
+	* write readiness if anything is left
+	* @return false if the connection failed and must be closed
+	*/
+	bool flush(Reactor& reactor, Connection* conn) {
+		int fd = conn->socket.native_handle();
+		// corked, the replies written together leave in full packets, and uncorking
+		// sends the last partial one at once instead of after the cork timeout
+		bool corked = cork_ && conn->outputStart < conn->output.size();
+		if (corked) {
+			conn->socket.set_cork(true);
+		}
+		while (conn->outputStart < conn->output.size()) {
+			// a client may go away while its replies are still being sent, fail the
+			// write rather than raising SIGPIPE
+			ssize_t n = ::send(fd, &conn->output[conn->outputStart], conn->output.size() - conn->outputStart, MSG_NOSIGNAL);
+			if (n < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				if (errno == EAGAIN || errno == EWOULDBLOCK) {
+					break;
+				}
+				return false;
+			}
+			conn->outputStart += n;
+		}
+		if (corked) {
+			conn->socket.set_cork(false);
+		}
+
+		bool pending = conn->outputStart < conn->output.size();
+		if (!pending) {
+			conn->output.clear();
+			conn->outputStart = 0;
+		}
+		conn->writing = pending;
+		watch(reactor, conn);
+		return true;
+	}
+
+	/**
+	* Registers the events a connection waits for: requests while it is reading,
+	* and write readiness while output is pending
+	*/
+	void watch(Reactor& reactor, Connection* conn) {
+		uint32_t events = (conn->reading() ? (uint32_t)(EPOLLIN | EPOLLRDHUP) : 0u) | (conn->writing ? (uint32_t)EPOLLOUT : 0u);
+		if (events == conn->events) {
+			return;
+		}
+		conn->events = events;
+		epoll_event ev;
+		ev.events = events;
+		ev.data.ptr = conn;
+		epoll_ctl(reactor.epoll, EPOLL_CTL_MOD, conn->socket.native_handle(), &ev);
+	}
+
+	/**
+	* Reads what is available on the connection, up to EVENT_LOOP_MAX_BUFFERED
+	* bytes, and services complete frames.  Once the client says goodbye or shuts
+	* down its side of the connection, no more requests are read, and the
+	* connection is closed when the replies to the requests already read have
+	* been sent.
+	* @return false if the connection is finished and must be closed
+	*/
+	bool receive(Reactor& reactor, Connection* conn) {
+		int fd = conn->socket.native_handle();
+
+		// a frame may be larger than one pass, so count what is read rather than
+		// what is buffered
+		size_t nread = 0;
+		while (nread < EVENT_LOOP_MAX_BUFFERED) {
+			ssize_t n = ::read(fd, conn->input.prepare(EVENT_LOOP_READ_SIZE), EVENT_LOOP_READ_SIZE);
+			if (n > 0) {
+				conn->input.commit(n);
+				nread += n;
+			}
+			else if (n == 0) {
+				conn->eof = true;  // peer closed, or shut down its side
+				break;
+			}
+			else if (errno == EINTR) {
+				continue;
+			}
+			else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+				break;
+			}
+			else {
+				return false;
+			}
+		}
+
+		if (!service(reactor, conn)) {
+			return false;
+		}
+
+		// pick up responses the handler produced right away
+		queueReplies(reactor);
+		if (reactor.connections.count(conn) == 0) {
+			return true;       // closed by queueReplies once its last reply went out
+		}
+		if (!flush(reactor, conn)) {
+			return false;
+		}
+		return !conn->finished();
+	}
+
+	/**
+	* Hands the complete frames buffered on a connection to the handler, until
+	* it is backlogged.  The rest wait in the buffer, and the connection stops
+	* being read, until its replies come back and are sent.
+	* @return false if a frame is malformed and the connection must be closed
+	*/
+	bool service(Reactor& reactor, Connection* conn) {
+		char id;
+		std::string payload;
+		while (!conn->closing && !conn->backlogged()) {
+			FrameStatus status = conn->input.next(id, payload);
+			if (status == FRAME_ERROR) {
+				return false;
+			}
+			if (status == FRAME_INCOMPLETE) {
+				if (conn->eof) {
+					conn->closing = true;   // every request the client sent has been read
+				}
+				break;
+			}
+
+			std::unique_ptr<Message> msg;
+			try {
+				msg = JsonUserClientApi::decodeFrame(id, payload);
+			}
+			catch (std::exception&) {
+				msg = nullptr;
+			}
+			if (msg == nullptr) {
+				return false;
+			}
+
+			if (msg->type() == MessageType::GOODBYE) {
+				conn->closing = true;
+			}
+			conn->inflight++;
+			Reply respond = reply(reactor, conn, id, msg->requestId);
+			handler_(std::move(msg), conn->id, respond);
+		}
+		watch(reactor, conn);
+		return true;
+	}
+
+	/**
+	* Creates the function used to send responses to a connection.  It only holds
+	* a weak reference, so a reply for a client that has since disconnected is dropped.
+	* Responses use the encoding of the request, identified by its frame type byte,
+	* and carry its request ID.
+	*/
+	Reply reply(Reactor& reactor, Connection* conn, char encoding, int requestId) {
+		std::weak_ptr<Connection> target = reactor.connections.find(conn)->second;
+		Reactor* r = &reactor;
+		return [r, target, encoding, requestId](std::unique_ptr<Message> response) {
+			// encode on the calling thread, keeping the work off the reactor
+			std::string frame;
+			if (response != nullptr) {
+				response->requestId = requestId;
+				frame = JsonUserClientApi::encodeFrame(*response, encoding);
+			}
+			{
+				std::lock_guard<std::mutex> lock(r->mutex);
+				r->replies.push_back(std::make_pair(target, std::move(frame)));
+			}
+			wake(*r);
+		};
+	}
+
+	/**
+	* Wakes up a reactor blocked in epoll_wait
+	*/
+	static void wake(Reactor& reactor) {
+		uint64_t one = 1;
+		if (::write(reactor.wakeup, &one, sizeof(one)) < 0) {
+			std::cerr << "Unable to wake reactor" << std::endl;
+		}
+	}
+
+	/**
+	* Registers connections handed over by the accepting thread
+	*/
+	void registerIncoming(Reactor& reactor) {
+		std::vector<std::shared_ptr<Connection>> incoming;
+		{
+			std::lock_guard<std::mutex> lock(reactor.mutex);
+			incoming.swap(reactor.incoming);
+		}
+
+		for (auto& conn : incoming) {
+			epoll_event ev;
+			ev.events = EPOLLIN | EPOLLRDHUP;
+			ev.data.ptr = conn.get();
+			if (epoll_ctl(reactor.epoll, EPOLL_CTL_ADD, conn->socket.native_handle(), &ev) != 0) {
+				std::cerr << "Unable to register client " << conn->id << std::endl;
+				continue;
+			}
+			reactor.connections[conn.get()] = conn;
+			std::cout << "Client " << conn->id << " connected" << std::endl;
+		}
+	}
+
+	/**
+	* Moves replies posted to this reactor onto their connections' output and flushes
+	* those connections
+	*/
+	void queueReplies(Reactor& reactor) {
+		std::vector<std::pair<std::weak_ptr<Connection>, std::string>> replies;
+		{
+			std::lock_guard<std::mutex> lock(reactor.mutex);
+			replies.swap(reactor.replies);
+		}
+
+		std::vector<Connection*> touched;
+		for (auto& reply : replies) {
+			std::shared_ptr<Connection> conn = reply.first.lock();
+			if (conn != nullptr) {
+				conn->inflight--;
+				conn->output.append(reply.second);
+				touched.push_back(conn.get());
+			}
+		}
+		for (Connection* conn : touched) {
+			if (reactor.connections.count(conn) == 0) {
+				continue;        // already closed in this pass
+			}
+			// replies have come back, service requests held back in the buffer
+			// and read the connection again
+			if (!flush(reactor, conn) || !service(reactor, conn) || conn->finished()) {
+				close(reactor, conn);
+			}
+		}
+	}
+
+	/**
+	* Unregisters and destroys a connection, closing its socket
+	*/
+	void close(Reactor& reactor, Connection* conn) {
+		std::cout << "Client " << conn->id << " disconnected" << std::endl;
+		epoll_ctl(reactor.epoll, EPOLL_CTL_DEL, conn->socket.native_handle(), nullptr);
+		reactor.connections.erase(conn);
+	}
+
+	/**
+	* Main function of a reactor thread
+	*/
+	void loop(Reactor& reactor) {
+		epoll_event events[EVENT_LOOP_MAX_EVENTS];
+
+		while (running_) {
+			int n = epoll_wait(reactor.epoll, events, EVENT_LOOP_MAX_EVENTS, -1);
+			if (n < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				std::cerr << "epoll_wait failed: " << errno << std::endl;
+				break;
+			}
+
+			for (int i = 0; i < n; i++) {
+				Connection* conn = (Connection*)events[i].data.ptr;
+				if (conn == nullptr) {
+					// woken up by a new client, a reply or stop()
+					uint64_t count;
+					if (::read(reactor.wakeup, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+						std::cerr << "Unable to read reactor wakeup: " << errno << std::endl;
+					}
+					registerIncoming(reactor);
+					queueReplies(reactor);
+					continue;
+				}
+				if (reactor.connections.count(conn) == 0) {
+					continue;        // closed earlier in this batch
+				}
+
+				bool keep = true;
+				if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+					keep = false;
+				}
+				if (keep && (events[i].events & EPOLLOUT)) {
+					// replies sent, service requests held back while they were pending
+					keep = flush(reactor, conn) && service(reactor, conn) && !conn->finished();
+				}
+				if (keep && (events[i].events & (EPOLLIN | EPOLLRDHUP))) {
+					keep = receive(reactor, conn);
+				}
+				if (!keep) {
+					close(reactor, conn);
+				}
+			}
+		}
+	}
+
+public:
+	/**
+	* Constructor - starts the reactor threads
+	* @param handler function servicing each received message
+	* @param nthreads number of reactor threads
+	* @param cork cork each connection while the replies queued for it are written
+	*/
+	EventLoopServer(Handler handler, size_t nthreads = EVENT_LOOP_THREADS, bool cork = false) :
+		handler_(handler), cork_(cork), reactors_(), running_(true), next_(0) {
+		if (nthreads == 0) {
+			nthreads = 1;
+		}
+		for (size_t i = 0; i < nthreads; i++) {
+			std::unique_ptr<Reactor> reactor(new Reactor());
+			reactor->epoll = epoll_create1(0);
+			reactor->wakeup = eventfd(0, EFD_NONBLOCK);
+
+			epoll_event ev;
+			ev.events = EPOLLIN;
+			ev.data.ptr = nullptr;
+			epoll_ctl(reactor->epoll, EPOLL_CTL_ADD, reactor->wakeup, &ev);
+
+			Reactor& r = *reactor;
+			reactor->thread = std::thread([this, &r]() { loop(r); });
+			reactors_.push_back(std::move(reactor));
+		}
+	}
+
+	EventLoopServer(const EventLoopServer&) = delete;
+	EventLoopServer& operator=(const EventLoopServer&) = delete;
+
+	~EventLoopServer() {
+		stop();
+	}
+
+	/**
+	* Hands a newly accepted client to one of the reactors
+	* @param client connected client socket
+	* @param id client id for printing messages to the console
+	* @return true if the client was handed over
+	*/
+	bool add(cpen333::process::socket&& client, int id) {
+		int fd = client.native_handle();
+		int flags = fcntl(fd, F_GETFL, 0);
+		if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+			return false;
+		}
+
+		// the reactor registers it with epoll on its own thread
+		Reactor& reactor = *reactors_[next_++ % reactors_.size()];
+		{
+			std::lock_guard<std::mutex> lock(reactor.mutex);
+			reactor.incoming.push_back(std::make_shared<Connection>(std::move(client), id));
+		}
+		wake(reactor);
+		return true;
+	}
+
+	/**
+	* Accepts clients until the server is closed, handing each to a reactor
+	* @param server open listening socket
+	*/
+	void run(cpen333::process::socket_server& server) {
+		cpen333::process::socket client;
+		int clientCount = 1;
+		while (running_ && server.accept(client)) {
+			add(std::move(client), clientCount);
+			clientCount++;
+		}
+	}
+
+	/**
+	* Stops all reactor threads and closes any connections still open.
+	*/
+	void stop() {
+		if (!running_.exchange(false)) {
+			return;
+		}
+		for (auto& reactor : reactors_) {
+			wake(*reactor);
+		}
+		for (auto& reactor : reactors_) {
+			reactor->thread.join();
+			reactor->connections.clear();
+			::close(reactor->wakeup);
+			::close(reactor->epoll);
+		}
+	}
+};
+
+#endif //__linux__
+
+#endif //PROJECT_EVENT_LOOP_SERVER_H
@@ -0,0 +1,131 @@
+/**
+ * @file
+ *
+ * This contains a reassembly buffer for framed messages arriving on a connection.
+ * Bytes are read from the socket into the buffer in large chunks, in whatever
+ * pieces the OS delivers them, and complete frames are extracted once all of their
+ * bytes have arrived, so a single read usually covers several small frames.
+ *
+ * Frame format (see JsonUserClientApi.h):
+ *   type ID (1 byte), payload size (4 bytes - big endian), payload
+ *
+ */
+#ifndef PROJECT_FRAME_BUFFER_H
+#define PROJECT_FRAME_BUFFER_H
+
+#include <vector>
+#include <string>
+#include <cstring>
+
+// size of the type byte plus the payload size
+#define FRAME_HEADER_SIZE 5
+// largest payload accepted from a peer, anything bigger is treated as garbage
+#define MAX_FRAME_SIZE (16*1024*1024)
+
+/**
+ * Result of trying to extract a frame
+ */
+enum FrameStatus {
+	FRAME_READY,       // a complete frame was extracted
+	FRAME_INCOMPLETE,  // more bytes are needed
+	FRAME_ERROR        // the stream is corrupt and the connection should be dropped
+};
+
+class FrameBuffer {
+	std::vector<char> buffer_;
+	size_t start_;   // first unconsumed byte
+	size_t end_;     // one past the last buffered byte, the rest is spare room
+
+	/**
+	* Makes sure there is room for a number of bytes after the buffered ones,
+	* first by moving the unconsumed bytes to the front and only then by growing
+	*/
+	void reserve(size_t size) {
+		if (buffer_.size() - end_ >= size) {
+			return;
+		}
+		if (start_ > 0) {
+			std::memmove(buffer_.data(), buffer_.data() + start_, end_ - start_);
+			end_ -= start_;
+			start_ = 0;
+		}
+		if (buffer_.size() - end_ < size) {
+			buffer_.resize(end_ + size);
+		}
+	}
+
+public:
+	/**
+	* Constructor - creates an empty buffer
+	*/
+	FrameBuffer() : buffer_(), start_(0), end_(0) {}
+
+	/**
+	* Appends bytes received from the connection
+	* @param data received bytes
+	* @param size number of bytes
+	*/
+	void append(const char* data, size_t size) {
+		reserve(size);
+		std::memcpy(buffer_.data() + end_, data, size);
+		end_ += size;
+	}
+
+	/**
+	* Provides room to read bytes from the connection straight into the buffer.
+	* Follow with commit() once the bytes are read.
+	* @param size maximum number of bytes to be read
+	* @return where to store the bytes
+	*/
+	char* prepare(size_t size) {
+		reserve(size);
+		return buffer_.data() + end_;
+	}
+
+	/**
+	* Adds bytes stored at the location returned by prepare()
+	* @param size number of bytes stored
+	*/
+	void commit(size_t size) {
+		end_ += size;
+	}
+
+	/**
+	* Number of buffered bytes not yet extracted as frames
+	*/
+	size_t size() const {
+		return end_ - start_;
+	}
+
+	/**
+	* Extracts the next complete frame
+	* @param id populated with the frame type byte
+	* @param payload populated with the frame payload
+	* @return FRAME_READY if a frame was extracted
+	*/
+	FrameStatus next(char& id, std::string& payload) {
+		if (size() < FRAME_HEADER_SIZE) {
+			return FRAME_INCOMPLETE;
+		}
+
+		const unsigned char* header = (const unsigned char*)&buffer_[start_];
+		size_t length = ((size_t)header[1] << 24) | ((size_t)header[2] << 16) | ((size_t)header[3] << 8) | header[4];
+		if (length > MAX_FRAME_SIZE) {
+			return FRAME_ERROR;
+		}
+		if (size() < FRAME_HEADER_SIZE + length) {
+			return FRAME_INCOMPLETE;
+		}
+
+		id = (char)header[0];
+		payload.assign(&buffer_[start_ + FRAME_HEADER_SIZE], length);
+		start_ += FRAME_HEADER_SIZE + length;
+		if (start_ == end_) {
+			start_ = 0;
+			end_ = 0;
+		}
+		return FRAME_READY;
+	}
+};
+
+#endif //PROJECT_FRAME_BUFFER_H
@@ -0,0 +1,223 @@
+/**
+ * @file
+ *
+ * This contains interned strings, used for item names.  Every distinct name is
+ * stored once, in a table shared by the whole process, and an InternedString
+ * only holds the name's number in the table.  Copying a name copies a 32-bit
+ * number and never allocates, and comparing two names compares their numbers.
+ *
+ * Names are added to the table under a mutex the first time they are seen and
+ * stay there until the process exits.  Looking up a name's text does not lock:
+ * the table is a fixed array of chunks that are filled in once and never move.
+ * Only the numbers are local to a process.  Names are still sent to clients,
+ * trucks and files as text.
+ *
+ * Only names the warehouse stocks are interned on the server, from inventory
+ * and restock data.  Names in clients' requests are looked up with find, so a
+ * client can't fill the table.
+ *
+ */
+#ifndef PROJECT_INTERNED_STRING_H
+#define PROJECT_INTERNED_STRING_H
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+#define INTERN_CHUNK_BITS 10      // names in each chunk of the table, as a power of two
+#define INTERN_MAX_CHUNKS 4096    // chunks in the table, so at most 4M distinct names
+
+class InternTable {
+	std::mutex mutex_;
+	std::unordered_map<std::string, uint32_t> ids_;   // nodes never move, so chunks point at their keys
+	std::unique_ptr<const std::string*[]> chunks_[INTERN_MAX_CHUNKS];
+	uint32_t size_;
+
+	InternTable() : mutex_(), ids_(), size_(0) {
+		intern(std::string());
+	}
+
+public:
+	InternTable(const InternTable&) = delete;
+	InternTable& operator=(const InternTable&) = delete;
+
+	/**
+	* @return the process's table
+	*/
+	static InternTable& instance() {
+		static InternTable table;
+		return table;
+	}
+
+	/**
+	* Finds the number of a name, adding the name if it is new
+	* @param name name to look up
+	* @return the name's number, 0 for the empty string
+	*/
+	uint32_t intern(const std::string& name) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		auto it = ids_.find(name);
+		if (it != ids_.end()) {
+			return it->second;
+		}
+		uint32_t chunk = size_ >> INTERN_CHUNK_BITS;
+		if (chunk >= INTERN_MAX_CHUNKS) {
+			throw std::length_error("intern table full");
+		}
+		if (!chunks_[chunk]) {
+			chunks_[chunk].reset(new const std::string*[(size_t)1 << INTERN_CHUNK_BITS]);
+		}
+		it = ids_.emplace(name, size_).first;
+		chunks_[chunk][size_ & ((1u << INTERN_CHUNK_BITS) - 1)] = &it->first;
+		return size_++;
+	}
+
+	/**
+	* Finds the number of a name without adding it
+	* @param name name to look up
+	* @param id populated with the name's number, if found
+	* @return true if the name is in the table
+	*/
+	bool find(const std::string& name, uint32_t& id) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		auto it = ids_.find(name);
+		if (it == ids_.end()) {
+			return false;
+		}
+		id = it->second;
+		return true;
+	}
+
+	/**
+	* Text of a name.  The number must have come from this table, so whoever
+	* added the name has already filled in its slot.
+	* @param id name's number
+	* @return the name, valid until the process exits
+	*/
+	const std::string& text(uint32_t id) const {
+		return *chunks_[id >> INTERN_CHUNK_BITS][id & ((1u << INTERN_CHUNK_BITS) - 1)];
+	}
+};
+
+class InternedString {
+	uint32_t id_;
+
+	explicit InternedString(uint32_t id, bool) : id_(id) {}
+
+public:
+	/**
+	* Constructor - the empty string
+	*/
+	InternedString() : id_(0) {}
+
+	/**
+	* Constructor - interns a string
+	* @param str text of the string
+	*/
+	InternedString(const std::string& str) : id_(InternTable::instance().intern(str)) {}
+
+	/**
+	* Constructor - interns a string
+	* @param str text of the string
+	*/
+	InternedString(const char* str) : id_(InternTable::instance().intern(std::string(str))) {}
+
+	/**
+	* Looks up a string that may never have been interned, e.g. a name a client
+	* searched for, without adding it to the table
+	* @param str text of the string
+	* @param out populated with the interned string, if found
+	* @return true if the string has been interned
+	*/
+	static bool find(const std::string& str, InternedString& out) {
+		uint32_t id;
+		if (!InternTable::instance().find(str, id)) {
+			return false;
+		}
+		out = InternedString(id, true);
+		return true;
+	}
+
+	/**
+	* @return the string's number in the table, equal numbers for equal strings
+	*/
+	uint32_t id() const {
+		return id_;
+	}
+
+	/**
+	* @return text of the string
+	*/
+	const std::string& str() const {
+		return InternTable::instance().text(id_);
+	}
+
+	const char* c_str() const {
+		return str().c_str();
+	}
+
+	bool empty() const {
+		return id_ == 0;
+	}
+
+	operator const std::string&() const {
+		return str();
+	}
+
+	// equal-to operators for comparisons, by number against another interned string
+	friend bool operator==(const InternedString& a, const InternedString& b) {
+		return a.id_ == b.id_;
+	}
+
+	friend bool operator==(const InternedString& a, const std::string& b) {
+		return a.str() == b;
+	}
+
+	friend bool operator==(const std::string& a, const InternedString& b) {
+		return a == b.str();
+	}
+
+	friend bool operator==(const InternedString& a, const char* b) {
+		return std::strcmp(a.c_str(), b) == 0;
+	}
+
+	// not-equal-to operators for comparisons
+	friend bool operator!=(const InternedString& a, const InternedString& b) {
+		return a.id_ != b.id_;
+	}
+
+	friend bool operator!=(const InternedString& a, const std::string& b) {
+		return !(a == b);
+	}
+
+	friend bool operator!=(const std::string& a, const InternedString& b) {
+		return !(a == b);
+	}
+
+	friend bool operator!=(const InternedString& a, const char* b) {
+		return !(a == b);
+	}
+
+	// overloaded stream operator for printing
+	friend std::ostream& operator<<(std::ostream& os, const InternedString& s) {
+		os << s.str();
+		return os;
+	}
+};
+
+namespace std {
+	template<>
+	struct hash<InternedString> {
+		size_t operator()(const InternedString& s) const {
+			return s.id();
+		}
+	};
+}
+
+#endif //PROJECT_INTERNED_STRING_H
@@ -0,0 +1,234 @@
+/**
+ * @file
+ *
+ * This contains the search engine behind WarehouseInventory::find.  Item name queries
+ * are classified before being run: exact names and "^prefix" queries are answered from
+ * a sorted name index, plain literals are matched with a substring search, and only
+ * real regular expressions go through std::regex, whose compiled form is kept in an
+ * LRU cache keyed by the pattern string.
+ *
+ */
+#ifndef PROJECT_INVENTORY_SEARCH_H
+#define PROJECT_INVENTORY_SEARCH_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <regex>
+
+// number of compiled patterns kept by the regex cache
+#define SEARCH_CACHE_SIZE 64
+
+/**
+ * Least-recently-used cache of compiled regular expressions
+ */
+class RegexCache {
+	typedef std::pair<std::string, std::shared_ptr<const std::regex>> CacheEntry;
+
+	std::mutex mutex_;
+	size_t capacity_;
+	std::list<CacheEntry> lru_;   // most recently used at the front
+	std::unordered_map<std::string, std::list<CacheEntry>::iterator> lookup_;
+
+public:
+	/**
+	* Constructor - creates an empty cache
+	* @param capacity maximum number of compiled patterns to keep
+	*/
+	RegexCache(size_t capacity = SEARCH_CACHE_SIZE) : mutex_(), capacity_(capacity), lru_(), lookup_() {}
+
+	/**
+	* Retrieves the compiled form of a pattern, compiling it on a miss.  Throws
+	* std::regex_error if the pattern is invalid, just like constructing the regex would.
+	* @param pattern regular expression
+	* @return compiled regular expression
+	*/
+	std::shared_ptr<const std::regex> get(const std::string& pattern) {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			auto it = lookup_.find(pattern);
+			if (it != lookup_.end()) {
+				lru_.splice(lru_.begin(), lru_, it->second);
+				return it->second->second;
+			}
+		}
+
+		// compile outside the lock, it is by far the slowest step
+		std::shared_ptr<const std::regex> compiled = std::make_shared<const std::regex>(pattern);
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		auto it = lookup_.find(pattern);
+		if (it != lookup_.end()) {
+			// another thread compiled it in the meantime
+			lru_.splice(lru_.begin(), lru_, it->second);
+			return it->second->second;
+		}
+		lru_.emplace_front(pattern, compiled);
+		lookup_[pattern] = lru_.begin();
+		if (lru_.size() > capacity_) {
+			lookup_.erase(lru_.back().first);
+			lru_.pop_back();
+		}
+		return compiled;
+	}
+
+	/**
+	* Number of compiled patterns currently cached
+	*/
+	size_t size() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return lru_.size();
+	}
+};
+
+/**
+ * Name search over the entries of a WarehouseInventory.  The owner reports every
+ * entry it stores through insert(), and passes its entries in when matching.
+ */
+class InventorySearch {
+public:
+	/**
+	* Kinds of name queries, from cheapest to most expensive
+	*/
+	enum QueryKind {
+		EXACT,    // ^name$
+		PREFIX,   // ^name
+		LITERAL,  // name, matches anywhere in the item name
+		REGEX
+	};
+
+private:
+	// item name -> slots holding that name, sorted so prefixes are contiguous
+	std::map<std::string, std::vector<size_t>> sortedNames;
+	// shared between copies, compiled patterns do not depend on the inventory
+	std::shared_ptr<RegexCache> cache_;
+
+	/**
+	* Checks whether a character has special meaning in an ECMAScript regex
+	*/
+	static bool isMeta(char c) {
+		switch (c) {
+		case '.': case '[': case ']': case '{': case '}': case '(': case ')':
+		case '\\': case '*': case '+': case '?': case '|': case '^': case '$':
+			return true;
+		default:
+			return false;
+		}
+	}
+
+public:
+	/**
+	* Constructor - creates an empty search index
+	*/
+	InventorySearch() : sortedNames(), cache_(std::make_shared<RegexCache>()) {}
+
+	/**
+	* Adds an item name to the sorted name index
+	* @param name item name
+	* @param slot position of the entry in the inventory vector
+	*/
+	void insert(const std::string& name, size_t slot) {
+		sortedNames[name].push_back(slot);
+	}
+
+	/**
+	* Empties the sorted name index
+	*/
+	void clear() {
+		sortedNames.clear();
+	}
+
+	/**
+	* Determines how a pattern can be answered
+	* @param pattern item name regular expression
+	* @param literal populated with the literal text of non-REGEX queries
+	* @return kind of query
+	*/
+	static QueryKind classify(const std::string& pattern, std::string& literal) {
+		size_t begin = 0;
+		size_t end = pattern.size();
+		bool anchoredStart = false;
+		bool anchoredEnd = false;
+
+		if (end > 0 && pattern[0] == '^') {
+			anchoredStart = true;
+			begin = 1;
+		}
+		if (end > begin && pattern[end - 1] == '$') {
+			anchoredEnd = true;
+			end--;
+		}
+		for (size_t i = begin; i < end; i++) {
+			if (isMeta(pattern[i])) {
+				return REGEX;
+			}
+		}
+
+		literal = pattern.substr(begin, end - begin);
+		if (anchoredStart && anchoredEnd) {
+			return EXACT;
+		}
+		else if (anchoredStart) {
+			return PREFIX;
+		}
+		else if (anchoredEnd) {
+			// suffix queries have no index to use
+			return REGEX;
+		}
+		return LITERAL;
+	}
+
+	/**
+	* Finds the entries whose names match a pattern
+	* @param pattern item name regular expression
+	* @param entries inventory entries, in slot order
+	* @return slots of matching entries, in no particular order
+	*/
+	template<typename Entry>
+	std::vector<size_t> match(const std::string& pattern, const std::vector<Entry>& entries) const {
+		std::vector<size_t> out;
+		std::string literal;
+
+		switch (classify(pattern, literal)) {
+		case EXACT: {
+			auto it = sortedNames.find(literal);
+			if (it != sortedNames.end()) {
+				out = it->second;
+			}
+			break;
+		}
+		case PREFIX: {
+			for (auto it = sortedNames.lower_bound(literal);
+				it != sortedNames.end() && it->first.compare(0, literal.size(), literal) == 0; ++it) {
+				out.insert(out.end(), it->second.begin(), it->second.end());
+			}
+			break;
+		}
+		case LITERAL: {
+			for (size_t i = 0; i < entries.size(); i++) {
+				if (entries[i].itemName.str().find(literal) != std::string::npos) {
+					out.push_back(i);
+				}
+			}
+			break;
+		}
+		case REGEX: {
+			std::shared_ptr<const std::regex> nregex = cache_->get(pattern);
+			for (size_t i = 0; i < entries.size(); i++) {
+				if (std::regex_search(entries[i].itemName.str(), *nregex)) {
+					out.push_back(i);
+				}
+			}
+			break;
+		}
+		}
+
+		return out;
+	}
+};
+
+#endif //PROJECT_INVENTORY_SEARCH_H
@@ -30,6 +30,9 @@ using JSON = nlohmann::json;
 #define MESSAGE_CANCEL "cancel"
 #define MESSAGE_CANCEL_RESPONSE "cancel_response"
 #define MESSAGE_GOODBYE "goodbye"
+#define MESSAGE_BUSY_RESPONSE "busy_response"
+#define MESSAGE_BATCH_ADD "batch_add"
+#define MESSAGE_BATCH_ADD_RESPONSE "batch_add_response"
 
 // other keys
 #define MESSAGE_TYPE "msg"
@@ -44,6 +47,8 @@ using JSON = nlohmann::json;
 #define MESSAGE_ITEM_WEIGHT "item_weight"
 #define MESSAGE_ORDER_NUM "order_num"
 #define MESSAGE_CART "cart"
+#define MESSAGE_REQUEST_ID "request_id"
+#define MESSAGE_SLA "sla"
 
 
 /**
@@ -58,7 +63,7 @@ class JsonConverter {
    */
   static JSON toJSON(Item item) {
     JSON j;
-	j[MESSAGE_ITEM_NAME] = item.itemName;
+	j[MESSAGE_ITEM_NAME] = item.itemName.str();
 	j[MESSAGE_ITEM_ID] = item.itemID;
 	j[MESSAGE_ITEM_QUANTITY] = item.itemQuantity;
 	j[MESSAGE_ITEM_WEIGHT] = item.itemWeight;
@@ -73,7 +78,7 @@ class JsonConverter {
   */
   static JSON toJSON(ItemEntry entry) {
 	  JSON j;
-	  j[MESSAGE_ITEM_NAME] = entry.itemName;
+	  j[MESSAGE_ITEM_NAME] = entry.itemName.str();
 	  j[MESSAGE_ITEM_ID] = entry.ID;
 	  j[MESSAGE_ITEM_PRICE] = entry.cost;
 	  j[MESSAGE_ITEM_QUANTITY] = entry.quantityAvailable;
@@ -184,6 +189,9 @@ class JsonConverter {
 	  JSON j;
 	  j[MESSAGE_TYPE] = MESSAGE_CONFIRM_ORDER;
 	  j[MESSAGE_CART] = toJSON(confirm.order);
+	  if (!confirm.sla.empty()) {
+		  j[MESSAGE_SLA] = confirm.sla;
+	  }
 	  return j;
   }
 
@@ -227,6 +235,45 @@ class JsonConverter {
 	  return j;
   }
 
+  /**
+  * Converts a "busy" response message to a JSON object
+  * @param busy_response message
+  * @return JSON object representation
+  */
+  static JSON toJSON(const BusyResponseMessage &busy_response) {
+	  JSON j;
+	  j[MESSAGE_TYPE] = MESSAGE_BUSY_RESPONSE;
+	  j[MESSAGE_INFO] = busy_response.info;
+	  j[MESSAGE_STATUS] = busy_response.status;
+	  return j;
+  }
+
+  /**
+  * Converts a "batch add" message to a JSON object
+  * @param batch message
+  * @return JSON object representation
+  */
+  static JSON toJSON(const BatchAddMessage &batch) {
+	  JSON j;
+	  j[MESSAGE_TYPE] = MESSAGE_BATCH_ADD;
+	  j[MESSAGE_CART] = toJSON(batch.items);
+	  return j;
+  }
+
+  /**
+  * Converts a "batch add" response message to a JSON object
+  * @param batch_response message
+  * @return JSON object representation
+  */
+  static JSON toJSON(const BatchAddResponseMessage &batch_response) {
+	  JSON j;
+	  j[MESSAGE_TYPE] = MESSAGE_BATCH_ADD_RESPONSE;
+	  j[MESSAGE_SEARCH_RESULTS] = toJSON(batch_response.results);
+	  j[MESSAGE_STATUS] = batch_response.status;
+	  j[MESSAGE_INFO] = batch_response.info;
+	  return j;
+  }
+
   /**
    * Converts a "goodbye" message to a JSON object
    * @param goodbye message
@@ -244,6 +291,19 @@ class JsonConverter {
    * @return JSON object representation, {"status"="ERROR", "info"=...} if not recognized
    */
   static JSON toJSON(const Message &msg) {
+    JSON j = toJSONBody(msg);
+    if (msg.requestId != 0) {
+      j[MESSAGE_REQUEST_ID] = msg.requestId;
+    }
+    return j;
+  }
+
+  /**
+   * Converts the contents of a message to a JSON object, without its request ID
+   * @param message
+   * @return JSON object representation, {"status"="ERROR", "info"=...} if not recognized
+   */
+  static JSON toJSONBody(const Message &msg) {
 
     switch(msg.type()) {
       case ADD: {
@@ -273,6 +333,15 @@ class JsonConverter {
       case GOODBYE: {
         return toJSON((GoodbyeMessage &) msg);
       }
+	  case BUSY_RESPONSE: {
+		  return toJSON((BusyResponseMessage &)msg);
+	  }
+	  case BATCH_ADD: {
+		  return toJSON((BatchAddMessage &)msg);
+	  }
+	  case BATCH_ADD_RESPONSE: {
+		  return toJSON((BatchAddResponseMessage &)msg);
+	  }
       default: {
 
       }
@@ -291,7 +360,7 @@ class JsonConverter {
    * @return Item
    */
   static Item parseItem(const JSON &j) {
-    return Item(j[MESSAGE_ITEM_NAME], j[MESSAGE_ITEM_ID], j[MESSAGE_ITEM_QUANTITY], j[MESSAGE_ITEM_WEIGHT]);
+    return Item(j[MESSAGE_ITEM_NAME].get<std::string>(), j[MESSAGE_ITEM_ID], j[MESSAGE_ITEM_QUANTITY], j[MESSAGE_ITEM_WEIGHT]);
   }
 
   /**
@@ -316,7 +385,7 @@ class JsonConverter {
   * @return ItemEntry
   */
   static ItemEntry parseEntry(const JSON &j) {
-	  return ItemEntry(j[MESSAGE_ITEM_NAME], j[MESSAGE_ITEM_QUANTITY], j[MESSAGE_ITEM_ID], j[MESSAGE_ITEM_WEIGHT], j[MESSAGE_ITEM_PRICE]);
+	  return ItemEntry(j[MESSAGE_ITEM_NAME].get<std::string>(), j[MESSAGE_ITEM_QUANTITY], j[MESSAGE_ITEM_ID], j[MESSAGE_ITEM_WEIGHT], j[MESSAGE_ITEM_PRICE]);
   }
 
   /**
@@ -335,6 +404,29 @@ class JsonConverter {
 	  return out;
   }
 
+  /**
+  * Converts a JSON array of item entries sent by a client.  Names are looked
+  * up rather than interned, so a client can't grow the table of names; an entry
+  * naming an item the warehouse doesn't stock is left with an empty name.
+  * @param jentry JSON array
+  * @param unknown populated with the first unknown name, if any
+  * @return resulting vector of ItemEntry
+  */
+  static std::vector<ItemEntry> parseKnownEntries(const JSON &jentry, std::string &unknown) {
+	  std::vector<ItemEntry> out;
+
+	  for (const auto&entry : jentry) {
+		  InternedString name;
+		  std::string text = entry[MESSAGE_ITEM_NAME];
+		  if (!InternedString::find(text, name) && unknown.empty()) {
+			  unknown = text;
+		  }
+		  out.push_back(ItemEntry(name, entry[MESSAGE_ITEM_QUANTITY], entry[MESSAGE_ITEM_ID], entry[MESSAGE_ITEM_WEIGHT], entry[MESSAGE_ITEM_PRICE]));
+	  }
+
+	  return out;
+  }
+
   /**
   * Converts a JSON object representing a Order to a Order object
   * @param j JSON object
@@ -369,7 +461,7 @@ class JsonConverter {
 	  std::vector<ItemEntry> results = parseEntries(jaddr[MESSAGE_SEARCH_RESULTS]);
     std::string status = jaddr[MESSAGE_STATUS];
     std::string info = jaddr[MESSAGE_INFO];
-    return AddResponseMessage(results, status, info);
+    return AddResponseMessage(std::move(results), status, info);
   }
 
 
@@ -393,7 +485,7 @@ class JsonConverter {
     std::vector<ItemEntry> results = parseEntries(jsearchr[MESSAGE_SEARCH_RESULTS]);
     std::string status = jsearchr[MESSAGE_STATUS];
     std::string info = jsearchr[MESSAGE_INFO];
-    return SearchResponseMessage(results, status, info);
+    return SearchResponseMessage(std::move(results), status, info);
   }
 
   /**
@@ -402,8 +494,16 @@ class JsonConverter {
   * @return ConfirmMessage
   */
   static ConfirmOrder parseConfirm(const JSON &jconfirm) {
-	  std::vector<ItemEntry> order = parseEntries(jconfirm[MESSAGE_CART]);
-	  return ConfirmOrder(order);
+	  std::string unknown;
+	  std::vector<ItemEntry> order = parseKnownEntries(jconfirm[MESSAGE_CART], unknown);
+	  std::string sla;
+	  auto jsla = jconfirm.find(MESSAGE_SLA);
+	  if (jsla != jconfirm.end() && jsla->is_string()) {
+		  sla = jsla->get<std::string>();
+	  }
+	  ConfirmOrder confirm(std::move(order), sla);
+	  confirm.unknownItem = std::move(unknown);
+	  return confirm;
   }
 
   /**
@@ -439,6 +539,41 @@ class JsonConverter {
 	  return CancelOrderResponseMessage(status, info);
   }
 
+  /**
+  * Converts a JSON object representing a BusyResponseMessage to a BusyResponseMessage object
+  * @param j JSON object
+  * @return BusyResponseMessage
+  */
+  static BusyResponseMessage parseBusyResponse(const JSON &jbusy) {
+	  std::string info = jbusy[MESSAGE_INFO];
+	  return BusyResponseMessage(info);
+  }
+
+  /**
+  * Converts a JSON object representing a BatchAddMessage to a BatchAddMessage object
+  * @param j JSON object
+  * @return BatchAddMessage
+  */
+  static BatchAddMessage parseBatchAdd(const JSON &jbatch) {
+	  std::string unknown;
+	  std::vector<ItemEntry> items = parseKnownEntries(jbatch[MESSAGE_CART], unknown);
+	  BatchAddMessage batch(std::move(items));
+	  batch.unknownItem = std::move(unknown);
+	  return batch;
+  }
+
+  /**
+  * Converts a JSON object representing a BatchAddResponseMessage to a BatchAddResponseMessage object
+  * @param j JSON object
+  * @return BatchAddResponseMessage
+  */
+  static BatchAddResponseMessage parseBatchAddResponse(const JSON &jbatchr) {
+	  std::vector<ItemEntry> results = parseEntries(jbatchr[MESSAGE_SEARCH_RESULTS]);
+	  std::string status = jbatchr[MESSAGE_STATUS];
+	  std::string info = jbatchr[MESSAGE_INFO];
+	  return BatchAddResponseMessage(std::move(results), status, info);
+  }
+
   /**
    * Converts a JSON object representing a GoodbyeMessage to a GoodbyeMessage object
    * @param j JSON object
@@ -477,6 +612,12 @@ class JsonConverter {
 		return MessageType::CANCEL_ORDER_RESPONSE;
     } else if (MESSAGE_GOODBYE == msg) {
       return MessageType::GOODBYE;
+    } else if (MESSAGE_BUSY_RESPONSE == msg) {
+      return MessageType::BUSY_RESPONSE;
+    } else if (MESSAGE_BATCH_ADD == msg) {
+      return MessageType::BATCH_ADD;
+    } else if (MESSAGE_BATCH_ADD_RESPONSE == msg) {
+      return MessageType::BATCH_ADD_RESPONSE;
     }
     return MessageType::UNKNOWN;
   }
@@ -489,6 +630,21 @@ class JsonConverter {
    * @return parsed Message object, or nullptr if invalid
    */
   static std::unique_ptr<Message> parseMessage(const JSON &jmsg) {
+    std::unique_ptr<Message> out = parseMessageBody(jmsg);
+    auto id = jmsg.find(MESSAGE_REQUEST_ID);
+    if (out != nullptr && id != jmsg.end()) {
+      out->requestId = *id;
+    }
+    return out;
+  }
+
+  /**
+   * Parses the contents of a Message object from JSON, without its request ID
+   *
+   * @param jmsg JSON object
+   * @return parsed Message object, or nullptr if invalid
+   */
+  static std::unique_ptr<Message> parseMessageBody(const JSON &jmsg) {
 
     MessageType type = parseType(jmsg);
     switch(type) {
@@ -519,6 +675,15 @@ class JsonConverter {
       case GOODBYE: {
         return std::unique_ptr<Message>(new GoodbyeMessage(parseGoodbye(jmsg)));
       }
+	  case BUSY_RESPONSE: {
+		  return std::unique_ptr<Message>(new BusyResponseMessage(parseBusyResponse(jmsg)));
+	  }
+	  case BATCH_ADD: {
+		  return std::unique_ptr<Message>(new BatchAddMessage(parseBatchAdd(jmsg)));
+	  }
+	  case BATCH_ADD_RESPONSE: {
+		  return std::unique_ptr<Message>(new BatchAddResponseMessage(parseBatchAddResponse(jmsg)));
+	  }
     }
 
     return std::unique_ptr<Message>(nullptr);
@@ -4,10 +4,12 @@
  * This file provides an implementation of the JsonUserClientAPI, encapsulating all information
  * required for communication between the client and server.
  *
- * The API currently only has one type of message: JSON_ID
+ * The API has two types of message: JSON_ID and BINARY_ID
  * An indicator byte is sent before each message so the receiving end knows that we
- * are not sending garbage data.  This is followed by a JSON-encoded string. All commands,
- * queries, and results are parsed from JSON.
+ * are not sending garbage data.  For JSON_ID this is followed by a JSON-encoded string,
+ * for BINARY_ID by the compact encoding described in BinaryConverter.h.  Each side
+ * answers in the encoding of the last message it received, so a server handles
+ * JSON and binary clients alike.
  *
  * Communication format:
  *   JSON_ID (1 byte), string size (4 bytes - little endian), JSON ASCII string
@@ -17,7 +19,9 @@
  *    0x55   0x11 0x00 0x00 0x00    0x7B 0x22 0x73 0x74 0x61 0x74 0x75 0x73 0x22 0x3A 0x20 0x22 0x4F 0x4B 0x22 0x7D 0x00
  *   <JSON>    <integer: 17>                <string: {"status": "OK"} >
  *
- *
+ * Binary messages use the same indicator byte and size prefix, without the
+ * terminating zero:
+ *   BINARY_ID (1 byte), payload size (4 bytes - big endian), binary payload
  *
  */
 
@@ -27,13 +31,19 @@
 #include "UserClientApi.h"
 #include "Message.h"
 #include "JsonConverter.h"
+#include "BinaryConverter.h"
+#include "FrameBuffer.h"
 
 #include <cpen333/process/socket.h>
 
 #include <algorithm> // for std::min
+#include <atomic>
+#include <map>
 
 // fixed port for server
 #define MUSIC_LIBRARY_SERVER_PORT 52134
+// largest read from the socket at once
+#define API_READ_SIZE 65536
 
 /**
  * Handles communication between sockets
@@ -46,103 +56,104 @@ class JsonUserClientApi : public UserClientApi {
   //   NOTE: constants like this don't actually have a memory address,
   //         so they can only be passed by value
   static const char JSON_ID = 0x55;
+  static const char BINARY_ID = 0x42;
 
-  /**
-   * Writes the JSON info to the socket, NOT including the JSON byte
-   * indicator (for symmetry with the read operation)
-   *
-   * @param j JSON content
-   * @return true if write successful, false otherwise
-   */
-  bool sendJSON(const JSON& j) {
+  // indicator byte of the encoding used by sendMessage, updated by recvMessage
+  // while a server may be sending responses from other threads
+  std::atomic<char> encoding_;
 
-    // dump to string
-    std::string jsonstr = j.dump();
+  // pipelined requests: last ID handed out and responses received before
+  // they were waited for
+  int lastRequestId_;
+  std::map<int, std::unique_ptr<Message>> early_;
 
-    // encode JSON size, big endian format
-    //   (most-significant byte in buff[0])
-    char buff[4];
-    size_t size = jsonstr.size()+1;           // one for terminating zero
-    for (int i=4; i-->0;) {
-      // cut off byte and shift size over by 8 bits
-      buff[i] = (char)(size & 0xFF);
-      size = size >> 8;
-    }
+  // bytes read from the socket but not yet parsed into messages
+  FrameBuffer input_;
 
-    // write contents
-    bool success  = socket_.write(buff, 4);   // contents size
-    success &= socket_.write(jsonstr);        // contents
+  // prevent default constructor
+  JsonUserClientApi();
 
-    return success;
-  }
+ public:
 
   /**
-   * Reads a string consisting of exactly size bytes
-   * @param str string to append to
-   * @param size number of bytes
-   * @return true if successful
+   * Main constructor, takes ownership of socket
+   * @param socket
    */
-  bool readString(std::string& str, size_t size) {
-
-	const int bufferSize = 256;
-    char cbuff[bufferSize];
-	bool success = false;
-
-	size_t nwritten = 0;
-	while (nwritten < size) {
-		int blocksize = std::min<size_t>(size - nwritten, bufferSize);
-		if (!socket_.read_all(cbuff, blocksize)) {
-			return false;
-		}		
-		str.append(cbuff, blocksize);
-		nwritten += blocksize;
-	}
-
-    return true;
-  }
+  JsonUserClientApi(cpen333::process::socket&& socket) :
+    socket_(std::move(socket)), encoding_(JSON_ID), lastRequestId_(0), early_(), input_() {}
 
   /**
-   * Reads and populates a JSON message
-   * Assumes the initial JSON indicator byte has already been read, which
-   * is why we are now in this method
-   *
-   * @param jout JSON object to populate
-   * @return true if successful, false if error
+   * Constructor selecting the encoding, takes ownership of socket
+   * @param socket
+   * @param binary true to send messages in the binary encoding, false for JSON
    */
-  bool recvJSON(JSON& jout) {
-
-    // receive 4-byte size
-    unsigned char buff[4];
-    if (!socket_.read_all(buff, 4)) {
-      return false;
-    }
+  JsonUserClientApi(cpen333::process::socket&& socket, bool binary) :
+    socket_(std::move(socket)), encoding_(binary ? BINARY_ID : JSON_ID), lastRequestId_(0), early_(), input_() {}
 
-	//const int byteSize = 8;
-	size_t size = (buff[0] << 24) | (buff[1] << 16) | (buff[2] << 8) | buff[3];
+  /**
+   * Move constructor, takes over the other API's socket
+   * @param other API to move from
+   */
+  JsonUserClientApi(JsonUserClientApi&& other) :
+    socket_(std::move(other.socket_)), encoding_(other.encoding_.load()),
+    lastRequestId_(other.lastRequestId_), early_(std::move(other.early_)),
+    input_(std::move(other.input_)) {}
 
-    // read entire JSON string
-    std::string str;
-    if (!readString(str, size)) {
-      return false;
+  /**
+   * Encodes a message as a complete frame, ready to be written to a socket
+   * in one piece.  Used by servers that manage the socket themselves.
+   *
+   * @param msg message to encode
+   * @param id frame type byte selecting the encoding, as received from the client
+   * @return type byte, 4-byte size and encoded message
+   */
+  static std::string encodeFrame(const Message& msg, char id = JSON_ID) {
+    if (id == BINARY_ID) {
+      std::string frame(5, '\0');
+      frame[0] = BINARY_ID;
+      BinaryConverter::encode(msg, frame);
+      size_t size = frame.size()-5;
+      for (int i=4; i>0; --i) {
+        frame[i] = (char)(size & 0xFF);
+        size = size >> 8;
+      }
+      return frame;
     }
 
-    // parse JSON
-    jout = JSON::parse(str);
+    std::string jsonstr = JsonConverter::toJSON(msg).dump();
+    size_t size = jsonstr.size()+1;           // one for terminating zero
 
-    return true;
+    std::string frame;
+    frame.reserve(5 + size);
+    frame.push_back(JSON_ID);
+    for (int i=4; i-->0;) {
+      frame.push_back((char)((size >> (8*i)) & 0xFF));
+    }
+    frame.append(jsonstr.c_str(), size);
+    return frame;
   }
 
-  // prevent default constructor
-  JsonUserClientApi();
-
- public:
-
   /**
-   * Main constructor, takes ownership of socket
-   * @param socket
+   * Decodes the payload of a frame received by a server that manages the
+   * socket itself
+   *
+   * @param id frame type byte
+   * @param payload frame contents following the 4-byte size
+   * @return parsed message, nullptr if the frame is not a valid message
    */
-  JsonUserClientApi(cpen333::process::socket&& socket) :
-    socket_(std::move(socket)) {}
+  static std::unique_ptr<Message> decodeFrame(char id, const std::string& payload) {
+    if (id == BINARY_ID) {
+      return BinaryConverter::decode(payload.data(), payload.size());
+    }
+    if (id != JSON_ID) {
+      return nullptr;
+    }
+    JSON jmsg = JSON::parse(payload.c_str(), nullptr, false);
+    if (jmsg.is_discarded()) {
+      return nullptr;
+    }
+    return JsonConverter::parseMessage(jmsg);
+  }
 
   /**
    * Sends a message by writing the data to the socket
@@ -150,15 +161,31 @@ class JsonUserClientApi : public UserClientApi {
    * @return true if successful, false if error
    */
   bool sendMessage(const Message& msg) {
-    JSON jmsg = JsonConverter::toJSON(msg);
+    if (encoding_ == BINARY_ID) {
+      // small enough to build in memory and write in one go, without the
+      // terminating zero write(std::string) would add
+      std::string frame = encodeFrame(msg, BINARY_ID);
+      return socket_.write(frame.data(), frame.size());
+    }
 
-    // write single JSON byte
-    char id = JSON_ID;
-    if (!socket_.write(&id, 1)) {
-      return false;
+    // dump to string
+    std::string jsonstr = JsonConverter::toJSON(msg).dump();
+
+    // JSON byte, then JSON size in big endian format
+    //   (most-significant byte in header[1])
+    char header[5];
+    header[0] = JSON_ID;
+    size_t size = jsonstr.size()+1;           // one for terminating zero
+    for (int i=4; i>0; --i) {
+      // cut off byte and shift size over by 8 bits
+      header[i] = (char)(size & 0xFF);
+      size = size >> 8;
     }
-    // write JSON content
-    return sendJSON(jmsg);
+
+    // header and contents leave in a single write, so they share a packet
+    const void* buffs[2] = { header, jsonstr.c_str() };
+    size_t sizes[2] = { sizeof(header), jsonstr.size()+1 };
+    return socket_.write(buffs, sizes, 2);
   }
 
   /**
@@ -174,19 +201,70 @@ class JsonUserClientApi : public UserClientApi {
    */
   std::unique_ptr<Message> recvMessage() {
 
-    // parse first byte, ensure it is of JSON type
+    // read until a whole frame is buffered, taking everything the socket has
+    // each time so following messages are usually already there
     char id;
-    if (!socket_.read_all(&id, 1) || id != JSON_ID) {
-      return nullptr;
+    std::string payload;
+    FrameStatus status;
+    while ((status = input_.next(id, payload)) == FRAME_INCOMPLETE) {
+      size_t nread = socket_.read(input_.prepare(API_READ_SIZE), API_READ_SIZE);
+      if (nread == 0) {
+        return nullptr;
+      }
+      input_.commit(nread);
     }
 
-    // if it is a JSON string, parse into a message
-    JSON jmsg;
-    if (!recvJSON(jmsg)) {
+    // ensure it is of a known type
+    if (status != FRAME_READY || (id != JSON_ID && id != BINARY_ID)) {
       return nullptr;
     }
+    // respond in kind
+    encoding_ = id;
 
-    return JsonConverter::parseMessage(jmsg);
+    return decodeFrame(id, payload);
+  }
+
+  /**
+   * Sends a request tagged with a new request ID, without waiting for the
+   * response, so several requests can be in flight at once
+   * @param msg request to write, its request ID is assigned
+   * @return request ID to wait for with recvResponse, 0 if error
+   */
+  int sendRequest(Message& msg) {
+    // skip 0, it marks untagged messages
+    if (++lastRequestId_ <= 0) {
+      lastRequestId_ = 1;
+    }
+    msg.requestId = lastRequestId_;
+    if (!sendMessage(msg)) {
+      return 0;
+    }
+    return msg.requestId;
+  }
+
+  /**
+   * Waits for the response to a request sent with sendRequest.  Responses
+   * may arrive in any order: those to other requests are kept until asked for.
+   *
+   * @param requestId ID returned by sendRequest
+   * @return response message, nullptr if an error occurred
+   */
+  std::unique_ptr<Message> recvResponse(int requestId) {
+    auto it = early_.find(requestId);
+    if (it != early_.end()) {
+      std::unique_ptr<Message> out = std::move(it->second);
+      early_.erase(it);
+      return out;
+    }
+
+    while (true) {
+      std::unique_ptr<Message> msg = recvMessage();
+      // untagged responses come from servers that answer in order
+      if (msg == nullptr || msg->requestId == requestId || msg->requestId == 0) {
+        return msg;
+      }
+      early_[msg->requestId] = std::move(msg);
+    }
   }
 
 };
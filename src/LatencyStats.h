@@ -0,0 +1,77 @@
+/**
+ * @file
+ *
+ * This contains a record of latencies for reporting percentiles.  It keeps the
+ * most recent LATENCY_SAMPLES of them, so percentiles follow how the warehouse is
+ * doing now and memory stays bounded however long it runs, plus a count and the
+ * maximum of every latency ever recorded.  It does no locking of its own.
+ *
+ */
+#ifndef PROJECT_LATENCY_STATS_H
+#define PROJECT_LATENCY_STATS_H
+
+#include <algorithm>
+#include <vector>
+
+#define LATENCY_SAMPLES 4096   // most recent latencies kept for percentiles
+
+/**
+ * Percentiles of recorded latencies, 0 if none were recorded
+ */
+struct LatencySummary {
+	long count;   // latencies ever recorded
+	long p50;
+	long p90;
+	long p99;
+	long max;     // largest latency ever recorded
+};
+
+class LatencyStats {
+	std::vector<long> samples_;
+	size_t next_;   // sample to overwrite once all LATENCY_SAMPLES are kept
+	long count_;
+	long max_;
+
+public:
+	/**
+	* Constructor - creates an empty record
+	*/
+	LatencyStats() : samples_(), next_(0), count_(0), max_(0) {}
+
+	/**
+	* Records a latency
+	* @param latency latency to record
+	*/
+	void record(long latency) {
+		if (samples_.size() < LATENCY_SAMPLES) {
+			samples_.push_back(latency);
+		}
+		else {
+			samples_[next_] = latency;
+			next_ = (next_ + 1) % LATENCY_SAMPLES;
+		}
+		count_++;
+		max_ = std::max(max_, latency);
+	}
+
+	/**
+	* @return percentiles of the recent latencies
+	*/
+	LatencySummary summary() const {
+		LatencySummary summary = { count_, 0, 0, 0, max_ };
+		if (samples_.empty()) {
+			return summary;
+		}
+		std::vector<long> sorted = samples_;
+		std::sort(sorted.begin(), sorted.end());
+		auto percentile = [&](int p) {
+			return sorted[(sorted.size() - 1) * p / 100];
+		};
+		summary.p50 = percentile(50);
+		summary.p90 = percentile(90);
+		summary.p99 = percentile(99);
+		return summary;
+	}
+};
+
+#endif //PROJECT_LATENCY_STATS_H
@@ -13,6 +13,7 @@
 #include "WarehouseObjects.h"
 #include "WarehouseInventory.h"
 #include <string>
+#include <utility>
 
 /**
  * Types of messages that can be sent between client/server
@@ -29,19 +30,29 @@ enum MessageType {
 	CANCEL_ORDER,
 	CANCEL_ORDER_RESPONSE,
 	GOODBYE,
+	BUSY_RESPONSE,
+	BATCH_ADD,
+	BATCH_ADD_RESPONSE,
 	UNKNOWN
 };
 
 // status messages for response objects
 #define MESSAGE_STATUS_OK "OK"
 #define MESSAGE_STATUS_ERROR "ERROR"
+#define MESSAGE_STATUS_BUSY "BUSY"
 
 /**
  * Base class for messages
  */
 class Message {
  public:
+  // tags a request so its response can be matched up when several requests
+  // are in flight, echoed back in the response; 0 if untagged
+  int requestId;
+
+  Message() : requestId(0) {}
   virtual MessageType type() const = 0;
+  virtual ~Message() {}
 };
 
 /**
@@ -49,8 +60,8 @@ class Message {
 */
 class ResponseMessage : public Message {
  public:
-  const std::string status;
-  const std::string info;
+  std::string status;
+  std::string info;
   ResponseMessage(const std::string& status,
                   const std::string& info = "") :
       status(status), info(info){}
@@ -66,7 +77,7 @@ class AddMessage : public Message {
   int itemQuantity;
   int itemID;
 
-  AddMessage(std::string name, int ID, int quantity)  : itemName(name), itemID(ID), itemQuantity(quantity) {}
+  AddMessage(std::string name, int ID, int quantity)  : itemName(std::move(name)), itemID(ID), itemQuantity(quantity) {}
 
   MessageType type() const {
     return MessageType::ADD;
@@ -81,7 +92,7 @@ class AddResponseMessage : public ResponseMessage {
 	 std::vector<ItemEntry> results;
 
   AddResponseMessage(std::vector<ItemEntry> results_, std::string status, std::string info ="") :
-      ResponseMessage(status, info), results(results_) {}
+      ResponseMessage(status, info), results(std::move(results_)) {}
 
   MessageType type() const {
     return MessageType::ADD_RESPONSE;
@@ -98,7 +109,7 @@ class SearchMessage : public Message {
   int itemID;
 
   SearchMessage(std::string name, int ID) :
-      itemName(name), itemID(ID) {}
+      itemName(std::move(name)), itemID(ID) {}
 
   MessageType type() const {
     return MessageType::SEARCH;
@@ -110,11 +121,11 @@ class SearchMessage : public Message {
  */
 class SearchResponseMessage : public ResponseMessage {
  public:
-  const std::vector<ItemEntry> results;
+  std::vector<ItemEntry> results;
 
-  SearchResponseMessage(std::vector<ItemEntry>& results,
+  SearchResponseMessage(std::vector<ItemEntry> results_,
     const std::string& status, const std::string& info = "" ) :
-      ResponseMessage(status, info), results(results) {}
+      ResponseMessage(status, info), results(std::move(results_)) {}
 
   MessageType type() const {
     return MessageType::SEARCH_RESPONSE;
@@ -127,8 +138,10 @@ class SearchResponseMessage : public ResponseMessage {
 class ConfirmOrder : public Message {
 public:
 	std::vector<ItemEntry> order;
+	std::string sla;   // service class, e.g. "express", empty for the warehouse's default
+	std::string unknownItem;   // set when received: an item name the warehouse doesn't stock, left out of the cart
 
-	ConfirmOrder(std::vector<ItemEntry> order_) : order(order_) {}
+	ConfirmOrder(std::vector<ItemEntry> order_, const std::string& sla_ = "") : order(std::move(order_)), sla(sla_) {}
 
 	MessageType type() const {
 		return MessageType::CONFIRM_ORDER;
@@ -178,6 +191,55 @@ public:
 	}
 };
 
+/**
+* Response sent instead of the normal response when the server is too
+* busy to accept the request
+*/
+class BusyResponseMessage : public ResponseMessage {
+public:
+
+	BusyResponseMessage(const std::string& info = "Server busy, please try again") :
+		ResponseMessage(MESSAGE_STATUS_BUSY, info) {}
+
+	MessageType type() const {
+		return MessageType::BUSY_RESPONSE;
+	}
+};
+
+/**
+ * Add several items to the Order at once.  Either every item is placed on
+ * hold or none are.
+ */
+class BatchAddMessage : public Message {
+ public:
+  // item name and ID of each item, quantityAvailable holds the quantity wanted
+  std::vector<ItemEntry> items;
+  // set when received: an item name the warehouse doesn't stock, left out of the items
+  std::string unknownItem;
+
+  BatchAddMessage(std::vector<ItemEntry> items_) : items(std::move(items_)) {}
+
+  MessageType type() const {
+    return MessageType::BATCH_ADD;
+  }
+};
+
+/**
+ * Response to adding several items.  On success the results are the updated
+ * entries of every item, on failure the entries that could not be held.
+ */
+class BatchAddResponseMessage : public ResponseMessage {
+ public:
+  std::vector<ItemEntry> results;
+
+  BatchAddResponseMessage(std::vector<ItemEntry> results_, std::string status, std::string info = "") :
+      ResponseMessage(status, info), results(std::move(results_)) {}
+
+  MessageType type() const {
+    return MessageType::BATCH_ADD_RESPONSE;
+  }
+};
+
 /**
  * Goodbye message
  */
@@ -0,0 +1,328 @@
+/**
+ * @file
+ *
+ * This contains a fixed-capacity lock-free multi-producer multi-consumer queue: a
+ * ring of cells, each with a sequence number telling producers and consumers whose
+ * turn it is to use it.  Adding or removing an element claims a cell with one
+ * compare-and-swap and never takes a lock, and elements are moved in and out of
+ * the queue rather than copied.
+ *
+ * Only threads that have to wait, for an element when the queue is empty or for
+ * room when it is full, sleep on a condition variable.  Threads that do not have
+ * to wait never touch its mutex.  Before going to sleep, a thread yields and tries
+ * again a few times: putting a thread to sleep and waking it costs far more than
+ * a yield, and the element or room it is waiting for is usually only a moment away.
+ *
+ */
+#ifndef PROJECT_MPMC_QUEUE_H
+#define PROJECT_MPMC_QUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#define MPMC_CACHE_LINE 64    // bytes, keeps the producer and consumer positions apart
+#define MPMC_SPIN_YIELDS 4    // times a thread yields and tries again before sleeping
+
+template<typename T>
+class MpmcQueue {
+	struct Cell {
+		std::atomic<size_t> sequence;   // position the cell is next free to add at, plus one once it is full
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+	};
+
+	std::unique_ptr<Cell[]> cells_;
+	size_t mask_;
+	alignas(MPMC_CACHE_LINE) std::atomic<size_t> enqueuePos_;
+	alignas(MPMC_CACHE_LINE) std::atomic<size_t> dequeuePos_;
+	alignas(MPMC_CACHE_LINE) std::atomic<size_t> popWaiters_;
+	std::atomic<size_t> pushWaiters_;
+	std::atomic<bool> closed_;
+	std::mutex popMutex_;
+	std::mutex pushMutex_;
+	std::condition_variable notEmpty_;
+	std::condition_variable notFull_;
+
+	/**
+	* Moves an element into the next free cell
+	* @return true if added, false if the queue is full
+	*/
+	bool enqueue(T&& value) {
+		Cell* cell;
+		size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+		for (;;) {
+			cell = &cells_[pos & mask_];
+			size_t seq = cell->sequence.load(std::memory_order_acquire);
+			intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+			if (dif == 0) {
+				if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			}
+			else if (dif < 0) {
+				return false;
+			}
+			else {
+				pos = enqueuePos_.load(std::memory_order_relaxed);
+			}
+		}
+		new (&cell->storage) T(std::move(value));
+		cell->sequence.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	* Moves the oldest element out of its cell
+	* @return true if removed, false if the queue is empty
+	*/
+	bool dequeue(T& value) {
+		Cell* cell;
+		size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+		for (;;) {
+			cell = &cells_[pos & mask_];
+			size_t seq = cell->sequence.load(std::memory_order_acquire);
+			intptr_t dif = (intptr_t)seq - (intptr_t)(pos + 1);
+			if (dif == 0) {
+				if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			}
+			else if (dif < 0) {
+				return false;
+			}
+			else {
+				pos = dequeuePos_.load(std::memory_order_relaxed);
+			}
+		}
+		T* element = reinterpret_cast<T*>(&cell->storage);
+		value = std::move(*element);
+		element->~T();
+		cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	* Wakes a thread waiting on a condition, if any are.  Taking the mutex makes
+	* sure a waiter is either asleep already or will see the change when it
+	* checks the condition.
+	*/
+	void wake(std::atomic<size_t>& waiters, std::mutex& mutex, std::condition_variable& cv) {
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (waiters.load(std::memory_order_relaxed) > 0) {
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+			}
+			cv.notify_one();
+		}
+	}
+
+	/**
+	* Tries an operation, yielding to other threads and trying again a few times
+	* if it fails
+	* @param tryOnce operation to try
+	* @return true if it succeeded
+	*/
+	template<typename Try>
+	static bool retry(Try tryOnce) {
+		for (int i = 0; i < MPMC_SPIN_YIELDS; i++) {
+			if (tryOnce()) {
+				return true;
+			}
+			std::this_thread::yield();
+		}
+		return false;
+	}
+
+	/**
+	* Sleeps until a condition holds, the queue is closed, or a deadline passes
+	* @param tryOnce checks the condition, acting on it if it holds
+	* @param deadline time to give up at, nullptr to wait as long as it takes
+	* @return true if the condition held
+	*/
+	template<typename Try>
+	bool await(std::atomic<size_t>& waiters, std::mutex& mutex, std::condition_variable& cv,
+		Try tryOnce, const std::chrono::steady_clock::time_point* deadline) {
+		bool done = false;
+		std::unique_lock<std::mutex> lock(mutex);
+		waiters.fetch_add(1);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		auto ready = [&] { return (done = tryOnce()) || closed_.load(); };
+		if (deadline == nullptr) {
+			cv.wait(lock, ready);
+		}
+		else {
+			cv.wait_until(lock, *deadline, ready);
+		}
+		waiters.fetch_sub(1);
+		return done;
+	}
+
+public:
+	/**
+	* Constructor - creates an empty queue
+	* @param capacity maximum number of queued elements, rounded up to a power of two
+	*/
+	MpmcQueue(size_t capacity) : cells_(), mask_(0), enqueuePos_(0), dequeuePos_(0),
+		popWaiters_(0), pushWaiters_(0), closed_(false), popMutex_(), pushMutex_(), notEmpty_(), notFull_() {
+		size_t size = 2;
+		while (size < capacity) {
+			size <<= 1;
+		}
+		cells_.reset(new Cell[size]);
+		mask_ = size - 1;
+		for (size_t i = 0; i < size; i++) {
+			cells_[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	MpmcQueue(const MpmcQueue&) = delete;
+	MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+	~MpmcQueue() {
+		size_t end = enqueuePos_.load();
+		for (size_t pos = dequeuePos_.load(); pos != end; pos++) {
+			Cell& cell = cells_[pos & mask_];
+			if (cell.sequence.load() == pos + 1) {
+				reinterpret_cast<T*>(&cell.storage)->~T();
+			}
+		}
+	}
+
+	/**
+	* Adds an element if there is room, without waiting
+	* @param value element to add, moved into the queue
+	* @return true if added, false if the queue is full or closed
+	*/
+	bool try_push(T&& value) {
+		if (closed_.load(std::memory_order_acquire) || !enqueue(std::move(value))) {
+			return false;
+		}
+		wake(popWaiters_, popMutex_, notEmpty_);
+		return true;
+	}
+
+	/**
+	* Adds an element, waiting for room if the queue is full
+	* @param value element to add, moved into the queue
+	* @return true if added, false if the queue was closed
+	*/
+	bool push(T&& value) {
+		if (retry([&] { return try_push(std::move(value)); })) {
+			return true;
+		}
+		if (closed_.load() || !await(pushWaiters_, pushMutex_, notFull_, [&] { return enqueue(std::move(value)); }, nullptr)) {
+			return false;
+		}
+		wake(popWaiters_, popMutex_, notEmpty_);
+		return true;
+	}
+
+	/**
+	* Adds an element, waiting a while for room if the queue is full
+	* @param value element to add, moved into the queue if added
+	* @param timeout longest time to wait
+	* @return true if added, false if there was no room in time or the queue was closed
+	*/
+	template<typename Rep, typename Period>
+	bool push_for(T&& value, const std::chrono::duration<Rep, Period>& timeout) {
+		if (retry([&] { return try_push(std::move(value)); })) {
+			return true;
+		}
+		auto deadline = std::chrono::steady_clock::now() + timeout;
+		if (closed_.load() || !await(pushWaiters_, pushMutex_, notFull_, [&] { return enqueue(std::move(value)); }, &deadline)) {
+			return false;
+		}
+		wake(popWaiters_, popMutex_, notEmpty_);
+		return true;
+	}
+
+	/**
+	* Removes the oldest element if there is one, without waiting
+	* @param value populated with the removed element
+	* @return true if an element was removed
+	*/
+	bool try_pop(T& value) {
+		if (!dequeue(value)) {
+			return false;
+		}
+		wake(pushWaiters_, pushMutex_, notFull_);
+		return true;
+	}
+
+	/**
+	* Removes the oldest element, waiting for one if the queue is empty
+	* @param value populated with the removed element
+	* @return true if an element was removed, false if the queue is closed and empty
+	*/
+	bool pop(T& value) {
+		if (retry([&] { return try_pop(value); })) {
+			return true;
+		}
+		if (!await(popWaiters_, popMutex_, notEmpty_, [&] { return dequeue(value); }, nullptr)) {
+			return false;
+		}
+		wake(pushWaiters_, pushMutex_, notFull_);
+		return true;
+	}
+
+	/**
+	* Removes the oldest element, waiting a while for one if the queue is empty
+	* @param value populated with the removed element
+	* @param timeout longest time to wait
+	* @return true if an element was removed, false if none came in time or the
+	*         queue is closed and empty
+	*/
+	template<typename Rep, typename Period>
+	bool pop_for(T& value, const std::chrono::duration<Rep, Period>& timeout) {
+		if (retry([&] { return try_pop(value); })) {
+			return true;
+		}
+		auto deadline = std::chrono::steady_clock::now() + timeout;
+		if (!await(popWaiters_, popMutex_, notEmpty_, [&] { return dequeue(value); }, &deadline)) {
+			return false;
+		}
+		wake(pushWaiters_, pushMutex_, notFull_);
+		return true;
+	}
+
+	/**
+	* Stops accepting elements and wakes up all waiting threads.  Elements
+	* already queued can still be removed.
+	*/
+	void close() {
+		closed_.store(true);
+		{
+			std::lock_guard<std::mutex> lock(popMutex_);
+		}
+		notEmpty_.notify_all();
+		{
+			std::lock_guard<std::mutex> lock(pushMutex_);
+		}
+		notFull_.notify_all();
+	}
+
+	/**
+	* Number of queued elements, which may already have changed by the time it is used
+	*/
+	size_t size() const {
+		size_t enqueued = enqueuePos_.load(std::memory_order_acquire);
+		size_t dequeued = dequeuePos_.load(std::memory_order_acquire);
+		return enqueued > dequeued ? enqueued - dequeued : 0;
+	}
+
+	/**
+	* Maximum number of queued elements
+	*/
+	size_t capacity() const {
+		return mask_ + 1;
+	}
+};
+
+#endif //PROJECT_MPMC_QUEUE_H
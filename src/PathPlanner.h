@@ -0,0 +1,234 @@
+/**
+ * @file
+ *
+ * This contains the path planner the robots use to move around the warehouse.
+ *
+ * When it is created, the planner runs a breadth-first search over the maze
+ * out from every shelf and every dock, recording for each floor cell how many
+ * steps it is from the nearest cell next to that shelf or dock. Robots then follow
+ * a shortest route by stepping to any neighbour one step closer, so they only walk
+ * to the shelves an order actually needs instead of the whole warehouse.
+ *
+ * The maze does not change once loaded, so after construction the planner is
+ * read-only and can be shared between robot threads without locking.
+ *
+ */
+#ifndef PROJECT_PATH_PLANNER_H
+#define PROJECT_PATH_PLANNER_H
+
+#include "WarehouseCommon.h"
+#include "WarehouseObjects.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#define PATH_UNREACHABLE 0xFFFF
+
+class PathPlanner {
+	int rows_;
+	int cols_;
+	std::vector<bool> floor_;                   // cells a robot can drive over, by cell index
+	std::vector<int> fieldOf_;                  // distance field of each target cell, -1 if none
+	std::vector<std::vector<uint16_t>> fields_; // steps from each cell to the target's access cells
+
+	int index(int row, int col) const {
+		return row * cols_ + col;
+	}
+
+	bool inside(int row, int col) const {
+		return row >= 0 && row < rows_ && col >= 0 && col < cols_;
+	}
+
+	bool isFloor(int row, int col) const {
+		return inside(row, col) && floor_[index(row, col)];
+	}
+
+	/**
+	* Runs a breadth-first search out from the cells a robot reaches a target from:
+	* the target itself if it is floor, otherwise the floor cells next to it
+	* @param row target row
+	* @param col target column
+	*/
+	void addField(int row, int col) {
+		static const int dr[4] = { 1, -1, 0, 0 };
+		static const int dc[4] = { 0, 0, 1, -1 };
+
+		std::vector<uint16_t> field(floor_.size(), PATH_UNREACHABLE);
+		std::deque<int> frontier;
+		if (isFloor(row, col)) {
+			field[index(row, col)] = 0;
+			frontier.push_back(index(row, col));
+		}
+		else {
+			for (int d = 0; d < 4; d++) {
+				int r = row + dr[d];
+				int c = col + dc[d];
+				if (isFloor(r, c)) {
+					field[index(r, c)] = 0;
+					frontier.push_back(index(r, c));
+				}
+			}
+		}
+
+		while (!frontier.empty()) {
+			int cell = frontier.front();
+			frontier.pop_front();
+			int r = cell / cols_;
+			int c = cell % cols_;
+			for (int d = 0; d < 4; d++) {
+				int nr = r + dr[d];
+				int nc = c + dc[d];
+				if (isFloor(nr, nc) && field[index(nr, nc)] == PATH_UNREACHABLE) {
+					field[index(nr, nc)] = field[cell] + 1;
+					frontier.push_back(index(nr, nc));
+				}
+			}
+		}
+
+		fieldOf_[index(row, col)] = (int)fields_.size();
+		fields_.push_back(std::move(field));
+	}
+
+	/**
+	* @return distance field of a target, nullptr if it has none
+	*/
+	const std::vector<uint16_t>* field(const Coordinates& target) const {
+		if (!inside(target.XCoordinates, target.YCoordinates)) {
+			return nullptr;
+		}
+		int f = fieldOf_[index(target.XCoordinates, target.YCoordinates)];
+		return f < 0 ? nullptr : &fields_[f];
+	}
+
+public:
+	/**
+	* Constructor - plans over a loaded warehouse layout, precomputing the distance
+	* fields of every shelf, dock, the robots' start and the exit
+	* @param winfo warehouse layout
+	* @param rinfo robot start and exit locations
+	*/
+	PathPlanner(const WarehouseInfo& winfo, const RobotInfo& rinfo) :
+		rows_(winfo.rows), cols_(winfo.cols), floor_(), fieldOf_(), fields_() {
+
+		floor_.resize(rows_ * cols_, false);
+		fieldOf_.resize(rows_ * cols_, -1);
+		for (int r = 0; r < rows_; r++) {
+			for (int c = 0; c < cols_; c++) {
+				char ch = winfo.maze[c][r];
+				floor_[index(r, c)] = (ch == EMPTY_CHAR || ch == ROBOT_PATH_CHAR ||
+					ch == START_CHAR || ch == EXIT_CHAR);
+			}
+		}
+
+		for (int r = 0; r < rows_; r++) {
+			for (int c = 0; c < cols_; c++) {
+				if (winfo.maze[c][r] == SHELF_CHAR || winfo.maze[c][r] == DOCK_CHAR) {
+					addField(r, c);
+				}
+			}
+		}
+		addField(rinfo.startx, rinfo.starty);
+		addField(rinfo.endx, rinfo.endy);
+	}
+
+	/**
+	* @return rows in the warehouse layout
+	*/
+	int rows() const {
+		return rows_;
+	}
+
+	/**
+	* @return columns in the warehouse layout
+	*/
+	int cols() const {
+		return cols_;
+	}
+
+	/**
+	* Checks whether a robot can drive over a cell
+	* @param cell cell to check
+	* @return true if the cell is floor
+	*/
+	bool passable(const Coordinates& cell) const {
+		return isFloor(cell.XCoordinates, cell.YCoordinates);
+	}
+
+	/**
+	* Number of steps from a cell to a target
+	* @param from cell to start at
+	* @param target shelf, dock, start or exit
+	* @return steps to reach the target, PATH_UNREACHABLE if there is no route
+	*/
+	int distance(const Coordinates& from, const Coordinates& target) const {
+		const std::vector<uint16_t>* f = field(target);
+		if (f == nullptr || !inside(from.XCoordinates, from.YCoordinates)) {
+			return PATH_UNREACHABLE;
+		}
+		return (*f)[index(from.XCoordinates, from.YCoordinates)];
+	}
+
+	/**
+	* Number of steps between two targets, from whichever cell next to the first
+	* is closest to the second
+	* @param from shelf, dock, start or exit to leave from
+	* @param target shelf, dock, start or exit
+	* @return steps between them, PATH_UNREACHABLE if there is no route
+	*/
+	int distanceBetween(const Coordinates& from, const Coordinates& target) const {
+		static const int dr[4] = { 1, -1, 0, 0 };
+		static const int dc[4] = { 0, 0, 1, -1 };
+
+		if (isFloor(from.XCoordinates, from.YCoordinates)) {
+			return distance(from, target);
+		}
+		int best = PATH_UNREACHABLE;
+		for (int d = 0; d < 4; d++) {
+			Coordinates cell(from.XCoordinates + dr[d], from.YCoordinates + dc[d]);
+			if (isFloor(cell.XCoordinates, cell.YCoordinates)) {
+				best = std::min(best, distance(cell, target));
+			}
+		}
+		return best;
+	}
+
+	/**
+	* Shortest route from a cell to a target
+	* @param from cell to start at
+	* @param target shelf, dock, start or exit
+	* @return cells to step through in order, not including from; empty if already
+	*         there or there is no route
+	*/
+	std::vector<Coordinates> path(const Coordinates& from, const Coordinates& target) const {
+		static const int dr[4] = { 1, -1, 0, 0 };
+		static const int dc[4] = { 0, 0, 1, -1 };
+
+		std::vector<Coordinates> out;
+		int steps = distance(from, target);
+		if (steps == PATH_UNREACHABLE) {
+			return out;
+		}
+
+		const std::vector<uint16_t>& f = *field(target);
+		int r = from.XCoordinates;
+		int c = from.YCoordinates;
+		out.reserve(steps);
+		while (f[index(r, c)] > 0) {
+			for (int d = 0; d < 4; d++) {
+				int nr = r + dr[d];
+				int nc = c + dc[d];
+				if (isFloor(nr, nc) && f[index(nr, nc)] == f[index(r, c)] - 1) {
+					r = nr;
+					c = nc;
+					break;
+				}
+			}
+			out.push_back(Coordinates(r, c));
+		}
+		return out;
+	}
+};
+
+#endif //PROJECT_PATH_PLANNER_H
@@ -4,53 +4,105 @@
 #include <iostream>
 #include <vector>
 #include <string>
-#include <deque>
-#include <mutex>
+#include <atomic>
+#include <utility>
 #include "WarehouseObjects.h"
-#include <cpen333\thread\semaphore.h>
+#include "WorkSignal.h"
+#include "SimClock.h"
+#include "SlaQueue.h"
 
 class PickupQueue {
-	std::deque<Order> pickupQueue;
-	std::mutex mutex_;
-	std::condition_variable cv_;
-	cpen333::thread::semaphore pickSemaphore;
+	SlaQueue pickupQueue;
+	SimClock& clock_;
+	std::atomic<WorkSignal*> signal_;
 public:
 	/**
-	* Constructor- creates a new picking queue
+	* Constructor- creates a new picking queue, handing out the order due soonest first
+	* @param clock clock to time orders by
+	* @param classes service classes orders are picked by, most urgent first
 	*/
-	PickupQueue() : pickupQueue(), mutex_(), cv_(), pickSemaphore(0) {}
+	PickupQueue(SimClock& clock, std::vector<SlaClass> classes = defaultSlaClasses()) :
+		pickupQueue(std::move(classes)), clock_(clock), signal_(nullptr) {}
 
 	/**
-	* Adds to picking queue 
-	* @param Order, confirmed order to be added to picking queue 
+	* Posts to a signal whenever an order is added
+	* @param signal signal shared with the other robot work queues
 	*/
-	void addToPQueue(Order& Order)
-	{
-		mutex_.lock();
-		pickupQueue.push_back(Order);
-		mutex_.unlock();
-		pickSemaphore.notify();
+	void attach(WorkSignal& signal) {
+		signal_ = &signal;
 	}
+
 	/**
-	* Removes an order from the picking queue
-	* @return next order in queue to be picked by robots
+	* Looks up a service class by name, for orders asking for one
+	* @param name class name, empty for the default class
+	* @return index of the class to set on the order
 	*/
-	Order removeFromPQueue(void)
+	int slaClass(const std::string& name) const {
+		return pickupQueue.find(name);
+	}
+
+	/**
+	* Adds to picking queue, due its service class's target from now
+	* @param order, confirmed order to be added to picking queue 
+	*/
+	void addToPQueue(Order order)
 	{
-		Order command; 
-		std::unique_lock <std::mutex> lock(mutex_);
-		bool success = pickSemaphore.try_wait();
-		if (success) {
-			// get first item in queue
-			command = pickupQueue.front();
-			pickupQueue.pop_front();
-			
+		pickupQueue.push(std::move(order), clock_.now());
+		WorkSignal* signal = signal_;
+		if (signal != nullptr) {
+			signal->post();
 		}
-		else {
-			command = Order(-1);
+	}
+
+	/**
+	* Removes an order from the picking queue without waiting
+	* @param order populated with the order due soonest
+	* @return true if there was an order
+	*/
+	bool tryRemoveFromPQueue(Order& order)
+	{
+		return pickupQueue.pop(order);
+	}
+
+	/**
+	* Puts orders taken without being picked back in the queue, with the deadlines
+	* they had.  The robots are not signalled again: orders taken directly with
+	* tryRemoveFromPQueue never used up the signal posted when they were added.
+	* @param orders orders to put back
+	*/
+	void returnToPQueue(std::vector<Order> orders)
+	{
+		for (auto &order : orders) {
+			pickupQueue.restore(std::move(order));
 		}
-		lock.unlock();
+	}
 
+	/**
+	* Records that an order has been picked, for its service class's latency
+	* @param order picked order
+	*/
+	void picked(const Order& order)
+	{
+		pickupQueue.picked(order, clock_.now());
+	}
+
+	/**
+	* Latency of the orders picked so far, per service class
+	* @return a report for each class, most urgent first
+	*/
+	std::vector<SlaReport> slaReport()
+	{
+		return pickupQueue.report();
+	}
+
+	/**
+	* Removes an order from the picking queue
+	* @return next order in queue to be picked by robots, order -1 if there is none
+	*/
+	Order removeFromPQueue(void)
+	{
+		Order command(-1);
+		tryRemoveFromPQueue(command);
 		return command;
 	}
 };
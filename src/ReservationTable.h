@@ -0,0 +1,266 @@
+/**
+ * @file
+ *
+ * This contains the space-time reservation table robots use to share the aisles.
+ *
+ * Time is split into ticks, the time a robot takes to move one cell, kept by a
+ * SimClock in real or virtual time.  Before it
+ * sets off, a robot plans its whole trip with an A* search over (cell, tick)
+ * states, moving or waiting in place each tick, and reserves every cell it will be
+ * in at every tick.  The search steers around cells other robots have already
+ * reserved and never swaps cells with another robot, so reserved trips cannot
+ * collide.  The path planner's distance fields are exact distances, so they make
+ * the search's heuristic.
+ *
+ * Every trip starts and ends at the robots' start or exit cell.  Any number of
+ * robots can stand still in those cells, only robots driving through them need
+ * to reserve them.  A robot that cannot reserve
+ * a trip waits there and tries again, so a robot in the aisles always has a
+ * reserved way out and robots cannot deadlock.  Each leg may only take a little
+ * longer than its shortest route: when the aisles are that busy it is cheaper to
+ * wait at the depot than to search further.
+ *
+ */
+#ifndef PROJECT_RESERVATION_TABLE_H
+#define PROJECT_RESERVATION_TABLE_H
+
+#include "PathPlanner.h"
+#include "SimClock.h"
+#include "WarehouseCommon.h"
+#include "WarehouseObjects.h"
+
+#include <cstdint>
+#include <mutex>
+#include <queue>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#define RESERVATION_SLACK 64      // most ticks a leg may spend waiting or detouring
+
+class ReservationTable {
+	const PathPlanner& planner_;
+	int start_;      // depot cells, never reserved
+	int exit_;
+	std::mutex mutex_;
+	std::unordered_map<uint64_t, int> reserved_;          // (tick, cell) to robot
+	std::unordered_map<int, std::vector<uint64_t>> owned_; // robot to its reservations
+	SimClock& clock_;
+
+	int cell(const Coordinates& c) const {
+		return c.XCoordinates * planner_.cols() + c.YCoordinates;
+	}
+
+	Coordinates coordinates(int cell) const {
+		return Coordinates(cell / planner_.cols(), cell % planner_.cols());
+	}
+
+	static uint64_t key(long tick, int cell) {
+		return ((uint64_t)tick << 20) | (uint64_t)cell;
+	}
+
+	bool isDepot(int cell) const {
+		return cell == start_ || cell == exit_;
+	}
+
+	/**
+	* Checks whether a robot may be in a cell at a tick
+	*/
+	bool isFree(int robot, int cell, long tick) const {
+		auto it = reserved_.find(key(tick, cell));
+		return it == reserved_.end() || it->second == robot;
+	}
+
+	/**
+	* Checks whether another robot moves the opposite way between two cells
+	* from a tick to the next
+	*/
+	bool crosses(int robot, int from, int to, long tick) const {
+		auto there = reserved_.find(key(tick, to));
+		if (there == reserved_.end() || there->second == robot) {
+			return false;
+		}
+		auto back = reserved_.find(key(tick + 1, from));
+		return back != reserved_.end() && back->second == there->second;
+	}
+
+	void releaseLocked(int robot) {
+		auto it = owned_.find(robot);
+		if (it != owned_.end()) {
+			for (uint64_t k : it->second) {
+				reserved_.erase(k);
+			}
+			owned_.erase(it);
+		}
+	}
+
+	/**
+	* Plans one leg of a trip with A* over (cell, tick)
+	* @param robot robot planning
+	* @param from cell the leg starts in
+	* @param tick tick the leg starts at
+	* @param target shelf, dock or depot to reach
+	* @param cells cell at each tick after the start, appended to
+	* @return true if a leg was found
+	*/
+	bool planLeg(int robot, int from, long tick, const Coordinates& target, std::vector<int>& cells) const {
+		static const int dr[5] = { 0, 1, -1, 0, 0 };
+		static const int dc[5] = { 0, 0, 0, 1, -1 };
+
+		// (f, g, cell), popped lowest f first, then furthest along
+		typedef std::tuple<int, int, int> Node;
+		auto later = [](const Node& a, const Node& b) {
+			return std::get<0>(a) != std::get<0>(b) ? std::get<0>(a) > std::get<0>(b) : std::get<1>(a) < std::get<1>(b);
+		};
+		std::priority_queue<Node, std::vector<Node>, decltype(later)> open(later);
+		std::unordered_map<uint64_t, int> parent;  // state to the cell one tick earlier
+		std::unordered_set<uint64_t> closed;
+
+		int h = planner_.distance(coordinates(from), target);
+		if (h == PATH_UNREACHABLE) {
+			return false;
+		}
+		open.push(Node(h, 0, from));
+
+		while (!open.empty()) {
+			Node node = open.top();
+			open.pop();
+			int g = std::get<1>(node);
+			int c = std::get<2>(node);
+			long t = tick + g;
+			if (!closed.insert(key(t, c)).second) {
+				continue;
+			}
+
+			if (planner_.distance(coordinates(c), target) == 0) {
+				size_t first = cells.size();
+				cells.resize(first + g);
+				for (int i = g; i > 0; i--) {
+					cells[first + i - 1] = c;
+					c = parent[key(tick + i, c)];
+				}
+				return true;
+			}
+			Coordinates at = coordinates(c);
+			for (int d = 0; d < 5; d++) {
+				Coordinates next(at.XCoordinates + dr[d], at.YCoordinates + dc[d]);
+				if (!planner_.passable(next)) {
+					continue;
+				}
+				int n = cell(next);
+				// any number of robots may stand still in a depot, but one leaving it
+				// holds it for the tick it leaves at, so no one can swap with it
+				bool parked = (n == c && isDepot(c));
+				bool leaving = (n != c && isDepot(c));
+				if (!parked && (!isFree(robot, n, t + 1) || (n != c && crosses(robot, c, n, t)) ||
+					(leaving && !isFree(robot, c, t)))) {
+					continue;
+				}
+				int nh = planner_.distance(next, target);
+				// distances are exact, so a state that cannot reach the target within the
+				// slack is a dead end
+				if (nh == PATH_UNREACHABLE || g + 1 + nh > h + RESERVATION_SLACK || closed.count(key(t + 1, n))) {
+					continue;
+				}
+				parent.emplace(key(t + 1, n), c);
+				open.push(Node(g + 1 + nh, g + 1, n));
+			}
+		}
+		return false;
+	}
+
+public:
+	/**
+	* Constructor - creates an empty table
+	* @param planner path planner of the warehouse, must outlive the table
+	* @param rinfo robot start and exit locations, the depots
+	* @param clock clock keeping the ticks, must outlive the table
+	*/
+	ReservationTable(const PathPlanner& planner, const RobotInfo& rinfo, SimClock& clock) :
+		planner_(planner), start_(), exit_(), mutex_(), reserved_(), owned_(), clock_(clock) {
+		start_ = cell(Coordinates(rinfo.startx, rinfo.starty));
+		exit_ = cell(Coordinates(rinfo.endx, rinfo.endy));
+	}
+
+	ReservationTable(const ReservationTable&) = delete;
+	ReservationTable& operator=(const ReservationTable&) = delete;
+
+	/**
+	* @return clock keeping the ticks
+	*/
+	SimClock& clock() {
+		return clock_;
+	}
+
+	/**
+	* Plans and reserves a whole trip, replacing the robot's earlier reservations
+	* @param robot robot id
+	* @param from depot the robot sets off from
+	* @param tick tick the robot sets off at
+	* @param stops shelves or docks to visit in order
+	* @param finish depot to end at
+	* @param route populated with the cell the robot must be in at each tick after
+	*        the start
+	* @param arrivals populated with the number of ticks into the route each stop
+	*        is reached at
+	* @return true if reserved, false if there is no way through yet and the robot
+	*         should wait and try again
+	*/
+	bool reserve(int robot, const Coordinates& from, long tick, const std::vector<Coordinates>& stops,
+		const Coordinates& finish, std::vector<Coordinates>& route, std::vector<size_t>& arrivals) {
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		releaseLocked(robot);
+
+		std::vector<int> cells;
+		arrivals.clear();
+		int at = cell(from);
+		for (size_t i = 0; i <= stops.size(); i++) {
+			const Coordinates& target = i < stops.size() ? stops[i] : finish;
+			if (!planLeg(robot, at, tick + (long)cells.size(), target, cells)) {
+				return false;
+			}
+			if (!cells.empty()) {
+				at = cells.back();
+			}
+			arrivals.push_back(cells.size());
+		}
+		arrivals.pop_back();
+
+		std::vector<uint64_t>& owned = owned_[robot];
+		auto hold = [&](long t, int c) {
+			uint64_t k = key(t, c);
+			reserved_[k] = robot;
+			owned.push_back(k);
+		};
+		route.clear();
+		route.reserve(cells.size());
+		for (size_t i = 0; i < cells.size(); i++) {
+			long t = tick + 1 + (long)i;
+			int previous = (i == 0) ? cell(from) : cells[i - 1];
+			if (cells[i] != previous) {
+				hold(t, cells[i]);
+				if (isDepot(previous)) {
+					hold(t - 1, previous);
+				}
+			}
+			else if (!isDepot(cells[i])) {
+				hold(t, cells[i]);
+			}
+			route.push_back(coordinates(cells[i]));
+		}
+		return true;
+	}
+
+	/**
+	* Drops all of a robot's reservations, once it is back at a depot
+	* @param robot robot id
+	*/
+	void release(int robot) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		releaseLocked(robot);
+	}
+};
+
+#endif //PROJECT_RESERVATION_TABLE_H
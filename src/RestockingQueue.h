@@ -4,10 +4,13 @@
 #include <iostream>
 #include <vector>
 #include <string>
-#include <deque>
-#include <mutex>
-#include <cpen333\thread\semaphore.h>
+#include <atomic>
+#include <utility>
 #include "WarehouseObjects.h"
+#include "WorkSignal.h"
+#include "MpmcQueue.h"
+
+#define RESTOCKING_QUEUE_CAPACITY 256   // most restocking trucks waiting to be unloaded
 
 class trCommand {
 	int loadingDockNumber;
@@ -27,52 +30,58 @@ public:
 };
 
 class RestockingQueue {
-	std::deque<trCommand> restockingQueue; 
-	std::mutex mutex_;
-	cpen333::thread::semaphore restockSemaphore;
+	MpmcQueue<trCommand> restockingQueue; 
+	std::atomic<WorkSignal*> signal_;
 
 public:
 	/**
 	* Constructor- creates a new empty truck queue
 	*/
-	RestockingQueue() : restockingQueue(), mutex_(), restockSemaphore(0) {}
+	RestockingQueue() : restockingQueue(RESTOCKING_QUEUE_CAPACITY), signal_(nullptr) {}
+
+	/**
+	* Posts to a signal whenever a command is added
+	* @param signal signal shared with the other robot work queues
+	*/
+	void attach(WorkSignal& signal) {
+		signal_ = &signal;
+	}
 
 
 	/**
-	* Adds to truck queue (instructions for robots)
+	* Adds to truck queue (instructions for robots), waiting for room if it is full
 	* @param command, command to be added to truck queue
 	*/
 	void addToTQueue(trCommand command)
 	{
-		mutex_.lock();
-		restockingQueue.push_front(command);
-		mutex_.unlock();
-		restockSemaphore.notify();
+		restockingQueue.push(std::move(command));
+		WorkSignal* signal = signal_;
+		if (signal != nullptr) {
+			signal->post();
+		}
+	}
+
+	/**
+	* Removes from truck queue without waiting
+	* @param command populated with the next command in queue
+	* @return true if there was a command
+	*/
+	bool tryRemoveFromTQueue(trCommand& command)
+	{
+		return restockingQueue.try_pop(command);
 	}
 
 
 	/**
 	* Removes from truck queue (instructions for robots)
-	* @return command to be added to be executed by robots
+	* @return command to be added to be executed by robots, dock -1 if there is none
 	*/
 	trCommand removeFromTQueue(void)
 	{
 		trCommand command(-1);
-		std::unique_lock <std::mutex> lock(mutex_);
-		bool success = restockSemaphore.try_wait();
-		if (success) {
-			// get first item in queue
-			command = restockingQueue.front();
-			restockingQueue.pop_front();
-
-		}
-		else {
-			command = trCommand(-1);
-		}
-		lock.unlock();
-
+		restockingQueue.try_pop(command);
 		return command;
 	}
 };
 
-#endif //PROJECT__RESTOCKINGQUEUE 
\ No newline at end of file
+#endif //PROJECT__RESTOCKINGQUEUE
\ No newline at end of file
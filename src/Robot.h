@@ -8,14 +8,20 @@
 #include <thread>
 #include <random>
 #include <math.h>
+#include <algorithm>
+#include <functional>
 
 #include "WarehouseCommon.h"
 #include "Shelf.h"
 #include "Warehouse.h"
 #include "WarehouseObjects.h"
-#include "PickupQueue.h"
-//#include "DeliveryQueue.h"
-#include "TruckQueue.h"
+#include "RobotDispatcher.h"
+#include "DeliveryCompQueue.h"
+#include "PathPlanner.h"
+#include "RouteOptimizer.h"
+#include "SlottingOptimizer.h"
+#include "WavePlanner.h"
+#include "ReservationTable.h"
 #include "safe_printf.h"
 
 
@@ -23,10 +29,11 @@
 * The Robot grabs orders from the pickupQueue, searches shelves 
 * for products to fulfill order, then adds the fulfilled orders to a 
 * new queue for the delivery robots to delivery. The Robot also grabs orders from the truckQueue
-* and takes them to a specified truck for delivery, or retrieve items from specific trucks and add them to the warehouse
+* and takes them to a specified truck for delivery, or retrieve items from specific trucks and add them to the warehouse.
+* Work from all queues is handed out by the RobotDispatcher; an idle robot sleeps until there is some.
 */
 class Robot : public cpen333::thread::thread_object {
-	cpen333::process::shared_object<SharedData> memory_;
+	cpen333::process::shared_object<SharedData> memory_;   // first, the planners below are built from its layout
 	cpen333::process::mutex mutex_;
 	
 	Coordinates currentPosition;
@@ -34,14 +41,17 @@ class Robot : public cpen333::thread::thread_object {
 	bool isFull;
 
 	
-	PickupQueue& pickup_;
-	//DeliveryQueue& delivery_;
-	TruckQueue & truck_; 
+	PathPlanner& planner_;
+	RouteOptimizer optimizer_;
+	SlottingOptimizer slotting_;
+	WavePlanner waves_;
+	ReservationTable& reservations_;
+	RobotDispatcher& dispatcher_;
+	DeliveryCompQueue& completed_;
 	Warehouse &warehouse;
 	int id_;
 
-	Order order;
-	Order POISON_ORDER = order; 
+	Order POISON_ORDER = Order(-1);
 	
 	void moveToCoordinates(Coordinates newCoordinates) {
 		currentPosition = newCoordinates;
@@ -53,66 +63,58 @@ class Robot : public cpen333::thread::thread_object {
 		memory_->rinfo.rloc[id_ - 1][ROW_IDX] = currentCoordinates.XCoordinates;
 	}
 
-	void moveToDock(int docknum) {
-		int r, c;
-		r = currentPosition.XCoordinates;
-		c = currentPosition.YCoordinates;
-		int prev_row = r;
-		int prev_col = c;
-		double dock_r, dock_c;
-
-		
-		{
-			std::lock_guard<decltype(mutex_)> mylock(mutex_);
-			dock_c = memory_->winfo.docks.dloc[docknum][COL_IDX];
-			dock_r = memory_->winfo.docks.dloc[docknum][ROW_IDX];
+	/**
+	* Drives from a depot through a list of stops to a depot. The whole trip is
+	* reserved before setting off, waiting at the depot until there is a way
+	* through, then driven one cell per tick
+	* @param stops shelves or docks to visit in order
+	* @param finish start or exit to end at
+	* @param atStop called with the index of each stop on reaching it
+	*/
+	void travel(const std::vector<Coordinates>& stops, const Coordinates& finish,
+		const std::function<void(size_t)>& atStop) {
+
+		std::vector<Coordinates> route;
+		std::vector<size_t> arrivals;
+		SimClock& clock = reservations_.clock();
+		long tick = clock.now();
+		while (!reservations_.reserve(id_, currentPosition, tick, stops, finish, route, arrivals)) {
+			if (memory_->quit) {
+				return;
+			}
+			clock.sleepUntil(tick + 1);
+			tick = clock.now();
 		}
 
-		int rdir = (dock_r - r) / (abs(r - dock_r)); // + dir = moving towards the dock
-		int cdir = (dock_c-c) / (abs(c - dock_c));
-
-		while (r != dock_r && c != dock_c) {
-			if (memory_->winfo.maze[c][r + rdir] != WALL_CHAR && 
-				memory_->winfo.maze[c][r + rdir] != SHELF_CHAR && (r + 1) != prev_row)
-			{
-				prev_row = r;
-				prev_col = c;
-				r = r + rdir;
-				currentPosition.XCoordinates = r;
-				currentPosition.YCoordinates = c;
-			}
-			else if (memory_->winfo.maze[c + cdir][r] != WALL_CHAR && 
-					memory_->winfo.maze[c+cdir][r] != SHELF_CHAR && (c + 1) != prev_col)
-			{
-				prev_row = r;
-				prev_col = c;
-				c = c + cdir;
-				currentPosition.XCoordinates = r;
-				currentPosition.YCoordinates = c;
+		size_t stop = 0;
+		for (size_t step = 0; ; step++) {
+			while (stop < arrivals.size() && arrivals[stop] == step) {
+				atStop(stop++);
 			}
-			else if (memory_->winfo.maze[c][r - rdir] != WALL_CHAR && 
-					memory_->winfo.maze[c][r - rdir] != SHELF_CHAR && (r - 1) != prev_row)
-			{
-				prev_row = r;
-				prev_col = c;
-				r = r - rdir;
-				currentPosition.XCoordinates = r;
-				currentPosition.YCoordinates = c;
-			}
-			else if (memory_->winfo.maze[c - cdir][r] != WALL_CHAR && 
-					memory_->winfo.maze[c - cdir][r] != SHELF_CHAR && (c - 1) != prev_col)
-			{
-				prev_row = r;
-				prev_col = c ;
-				c = c - cdir;
-				currentPosition.XCoordinates = r;
-				currentPosition.YCoordinates = c;
+			if (step == route.size() || memory_->quit) {
+				break;
 			}
+			clock.sleepUntil(tick + (long)step + 1);
+			currentPosition = route[step];
 			updateCoordinates(currentPosition);
-			std::this_thread::sleep_for(std::chrono::milliseconds(100));
-
 		}
+		reservations_.release(id_);
+	}
 
+	/**
+	* Drives to a dock and back to the start
+	* @param docknum dock to drive to
+	* @param atDock called on reaching the dock
+	*/
+	void moveToDock(int docknum, const std::function<void(size_t)>& atDock) {
+		Coordinates dock;
+		Coordinates start;
+		{
+			std::lock_guard<decltype(mutex_)> mylock(mutex_);
+			dock = Coordinates(memory_->winfo.docks.dloc[docknum][ROW_IDX], memory_->winfo.docks.dloc[docknum][COL_IDX]);
+			start = Coordinates(memory_->rinfo.startx, memory_->rinfo.starty);
+		}
+		travel(std::vector<Coordinates>(1, dock), start, atDock);
 	}
 
 	void unloadTruck(int dockNumber) {
@@ -124,12 +126,15 @@ public:
 	/**
 	* Constructor- create a new robot
 	* @param id the  robot's id
-	* @param pickup queue to read orders from
-	* @param delivery queue to add completed orders to
+	* @param warehouse shelves to pick orders from
+	* @param planner routes around the warehouse
+	* @param reservations cells reserved by the robots' trips
+	* @param dispatcher hands out orders to pick and trucks to load/unload
+	* @param completed queue to add picked orders to
 	*/
-	Robot(int id, Warehouse &warehouse, PickupQueue& pickup) :
+	Robot(int id, Warehouse &warehouse, PathPlanner& planner, ReservationTable& reservations, RobotDispatcher& dispatcher, DeliveryCompQueue& completed) :
 
-		id_(id), warehouse(warehouse), pickup_(pickup), memory_(WAREHOUSE_MEMORY_NAME), mutex_(WAREHOUSE_MUTEX_NAME) {
+		memory_(WAREHOUSE_MEMORY_NAME), mutex_(WAREHOUSE_MUTEX_NAME), planner_(planner), optimizer_(planner), slotting_(planner, memory_->rinfo), waves_(planner, memory_->rinfo), reservations_(reservations), dispatcher_(dispatcher), completed_(completed), warehouse(warehouse), id_(id) {
 		currentPosition = Coordinates(memory_->rinfo.startx, memory_->rinfo.starty);
 		isFull = false;
 	}
@@ -163,205 +168,258 @@ public:
 	}
 	
 	/**
-	* Algorithm for moving robot around maze and picking items
-	* off the shelves and storing into their holding list
-	* @param order Order to be fulfilled
-	* @param memory_ shared memory for updating inventory
+	* Chooses the orders to pick on the next trip: the waiting order the assignment
+	* engine gives this robot, and the waiting orders worth picking with it
+	* @param first order the robot was given, the one due soonest, moved into the wave
+	* @return orders to pick in one trip, the assigned order first
 	*/
-	void follow_path(Order &order, cpen333::process::shared_object<SharedData>& memory_) {
-
-		Coordinates currentPos = getPosition();
-		
-		int c = currentPos.YCoordinates;
-		int r = currentPos.XCoordinates;
-		int prev_row = r;
-		int prev_col = c; 
-		
-		while (memory_->winfo.maze[c][r] != EXIT_CHAR && memory_->quit == false)
-		{
-			memory_->rinfo.rloc[id_-1][COL_IDX] = c;
-			memory_->rinfo.rloc[id_-1][ROW_IDX] = r;
-			if (memory_->winfo.maze[c][r + 1] == ROBOT_PATH_CHAR && (r + 1) != prev_row)
-			{
-				prev_row = r;
-				prev_col = c;
-				r = r + 1;
-				currentPosition.XCoordinates = r;
-				pickup(c, r, order, memory_);
+	std::vector<Order> gatherWave(Order &first) {
+		std::vector<Order> pending = dispatcher_.takePickups(WAVE_CANDIDATES);
+
+		// orders to consider, leaving the end-of-day order for its own robot
+		std::vector<Order> orders;
+		orders.reserve(pending.size() + 1);
+		orders.push_back(std::move(first));
+		std::vector<Order> left;
+		for (auto &order : pending) {
+			if (order.getOrderNum() == POISON_ORDER.getOrderNum()) {
+				left.push_back(std::move(order));
 			}
-			else if (memory_->winfo.maze[c][r - 1] == ROBOT_PATH_CHAR && ((r - 1) != prev_row))
-			{
-				prev_row = r;
-				prev_col = c;
-				r = r - 1;
-				currentPosition.XCoordinates = r;
-				pickup(c, r, order, memory_);
+			else {
+				orders.push_back(std::move(order));
 			}
-			else if (memory_->winfo.maze[c + 1][r] == ROBOT_PATH_CHAR && ((c + 1) != prev_col))
+		}
+
+		AssignmentEngine* engine = dispatcher_.engine();
+		size_t seed = 0;
+		std::vector<Order> wave;
+		if (orders.size() > 1) {
+			std::vector<WaveOrder> waiting;
 			{
-				prev_row = r;
-				prev_col = c;
-				c = c + 1;
-				currentPosition.YCoordinates = c;
-				pickup(c, r, order, memory_);
+				std::lock_guard<decltype(mutex_)> mylock(mutex_);
+				for (auto &order : orders) {
+					waiting.push_back(waveOrder(order));
+				}
 			}
-			else if (memory_->winfo.maze[c - 1][r] == ROBOT_PATH_CHAR && ((c - 1) != prev_col))
-			{
-				prev_row = r;
-				prev_col = c;
-				c = c - 1;
-				currentPosition.YCoordinates = c;
-				pickup(c, r, order, memory_);
 
+			// the order this robot can complete soonest, counting how soon each is due
+			if (engine != nullptr) {
+				RobotState state = { currentPosition, MAX_ROBOT_CAPACITY };
+				seed = (size_t)engine->match(std::vector<RobotState>(1, state), waiting)[0];
 			}
-			else if (memory_->winfo.maze[c][r + 1] == EXIT_CHAR || memory_->winfo.maze[c+1][r] == EXIT_CHAR ||
-				memory_->winfo.maze[c][r - 1] == EXIT_CHAR || memory_->winfo.maze[c-1][r] == EXIT_CHAR) {
-				r = memory_->rinfo.endx;
-				c = memory_->rinfo.endy;
-				currentPosition = Coordinates(r, c);
+
+			std::vector<size_t> rest;
+			std::vector<WaveOrder> others;
+			for (size_t i = 0; i < orders.size(); i++) {
+				if (i != seed) {
+					rest.push_back(i);
+					others.push_back(waiting[i]);
+				}
 			}
-			updateCoordinates(currentPosition);
-			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+			std::vector<bool> joined(rest.size(), false);
+			for (size_t i : waves_.plan(waiting[seed], others, dispatcher_.idleRobots())) {
+				joined[i] = true;
+			}
+
+			wave.push_back(std::move(orders[seed]));
+			std::vector<Order> back;
+			for (size_t i = 0; i < rest.size(); i++) {
+				if (joined[i]) {
+					wave.push_back(std::move(orders[rest[i]]));
+				}
+				else {
+					back.push_back(std::move(orders[rest[i]]));
+				}
+			}
+			for (auto &order : left) {
+				back.push_back(std::move(order));
+			}
+			left = std::move(back);
 		}
+		else {
+			wave.push_back(std::move(orders[0]));
+		}
+		dispatcher_.returnPickups(std::move(left));
+		return wave;
 	}
 
 	/**
-	* Find's the shelf located at Coordinates [r, c]
-	* @param r row in the warehouse layout 
-	* @param c column in the warehouse layout 
-	* @param memory_ shared memory for accessing shelf coordinates 
-	* @return shelf at corresponding location [r,c]
+	* Describes an order for wave planning: the closest shelf stocking each item,
+	* the weight of the items, and how soon it is due.  Call with the warehouse locked.
+	* @param order order to describe
+	* @return what the wave planner needs to know
 	*/
-	
-	Shelf findShelf(int c, int r, cpen333::process::shared_object<SharedData>& memory_) {
-
-		Coordinates coord(r, c);
-
-		for (auto &shelf : warehouse.Shelves) {
-			if (shelf.shelfCoordinates.YCoordinates == r && shelf.shelfCoordinates.XCoordinates == c) {
-				return shelf;
+	WaveOrder waveOrder(Order &order) {
+		WaveOrder wave;
+		wave.weight = 0;
+		wave.slack = order.getDeadline() - reservations_.clock().now();
+		Coordinates start(memory_->rinfo.startx, memory_->rinfo.starty);
+		for (auto &item : order.orderList) {
+			wave.weight += item.itemWeight * item.itemQuantity;
+			int closest = -1;
+			int steps = PATH_UNREACHABLE;
+			for (auto &location : warehouse.stockOf(item.itemID)) {
+				int d = planner_.distance(start, warehouse.Shelves[location.shelf].shelfLocation());
+				if (d < steps) {
+					steps = d;
+					closest = location.shelf;
+				}
+			}
+			if (closest >= 0) {
+				wave.shelves.push_back(warehouse.Shelves[closest].shelfLocation());
 			}
 		}
-		return Shelf(coord);
+		return wave;
 	}
 
 	/**
-	* Obtains product from the shelf and into robot holding items list 
-	* if there is enough product in stock to fulfill the order 
-	* @param r row in the warehouse layout
-	* @param c column in the warehouse layout
-	* @param memory_ shared memory for accessing shelf inventory list
+	* Moves the robot to the shelves holding the ordered items, in the shortest
+	* order the route optimizer finds, picks the items into its holding list,
+	* then drives to the exit
+	* @param orders orders to be fulfilled in one trip
+	* @param memory_ shared memory for the exit location
 	*/
-	void pickup(int c, int r, Order &order, cpen333::process::shared_object<SharedData>& memory_) {
-		std::vector<Item> list = order.orderList;
-		
-		if (memory_->winfo.maze[c][r + 1] == SHELF_CHAR)
-		{
-			Shelf shelf = findShelf(c, (r+1), memory_);
-			for (auto &item : list) {
-				std::string name = item.itemName;
-				for (auto &inventory_item : shelf.inventory) {
-					std::string inventory_name = inventory_item.itemName;
-					if (name == inventory_name) {
-						shelf.releaseItem(item, holdingItems, item.itemQuantity);
+	void follow_path(std::vector<Order> &orders, cpen333::process::shared_object<SharedData>& memory_) {
+
+		// quantity still to pick of each item, over all the orders
+		std::vector<Item> remaining;
+		for (auto &order : orders) {
+			for (auto &item : order.orderList) {
+				bool listed = false;
+				for (auto &r : remaining) {
+					if (r.itemID == item.itemID) {
+						r.itemQuantity += item.itemQuantity;
+						listed = true;
+						break;
 					}
 				}
-				
-			}
-
-			if (list == holdingItems) {
-				isFull = true;
+				if (!listed) {
+					remaining.push_back(item);
+				}
 			}
 		}
+		Coordinates exit(memory_->rinfo.endx, memory_->rinfo.endy);
+
+		// other robots may empty a shelf before we get there, so plan again
+		// until nothing more can be found, or a whole trip finds nothing
+		while (memory_->quit == false) {
+			std::vector<Shelf*> shelves = chooseShelves(remaining);
+			if (shelves.empty()) {
+				break;
+			}
 
-		else if (memory_->winfo.maze[c][r - 1] == SHELF_CHAR)
-		{
-			Shelf shelf = findShelf(c, (r-1), memory_);
-			for (auto &item : list) {
-				std::string name = item.itemName;
-				for (auto &inventory_item : shelf.inventory) {
-					std::string inventory_name = inventory_item.itemName;
-					if (name == inventory_name) {
-						shelf.releaseItem(item, holdingItems, item.itemQuantity);
-					}
-				}
-
+			std::vector<Coordinates> stops;
+			for (auto shelf : shelves) {
+				stops.push_back(shelf->shelfLocation());
 			}
-			if (list == holdingItems) {
-				isFull = true;
+			std::vector<size_t> visits = optimizer_.plan(currentPosition, stops, exit);
+			std::vector<Coordinates> ordered;
+			for (size_t i : visits) {
+				ordered.push_back(stops[i]);
+			}
+			int picked = 0;
+			travel(ordered, exit, [&](size_t stop) {
+				picked += pickup(*shelves[visits[stop]], remaining);
+			});
+			if (picked == 0) {
+				break;
 			}
-
 		}
-		else if (memory_->winfo.maze[c + 1][r] == SHELF_CHAR)
-		{
-			Shelf shelf = findShelf((c+1), r, memory_);
-			for (auto &item : list) {
-				std::string name = item.itemName;
-				for (auto &inventory_item : shelf.inventory) {
-					std::string inventory_name = inventory_item.itemName;
-					if (name == inventory_name) {
-						shelf.releaseItem(item, holdingItems, item.itemQuantity);
-					}
-				}
 
+		isFull = true;
+		for (auto &item : remaining) {
+			if (item.itemQuantity > 0) {
+				isFull = false;
 			}
+		}
+	}
 
-			if (list == holdingItems) {
-				isFull = true;
+	/**
+	* Chooses shelves to pick the items still needed from, taking each item from
+	* the shelves closest to the robot until there is enough of it
+	* @param remaining items still to pick
+	* @return shelves to visit, each at most once
+	*/
+	std::vector<Shelf*> chooseShelves(const std::vector<Item> &remaining) {
+		std::vector<Shelf*> chosen;
+		std::lock_guard<decltype(mutex_)> mylock(mutex_);
+		for (auto &item : remaining) {
+			// shelves stocking the item, closest first
+			const std::vector<StockLocation> &locations = warehouse.stockOf(item.itemID);
+			std::vector<std::pair<int, size_t>> stocked;
+			for (size_t i = 0; i < locations.size(); i++) {
+				int steps = planner_.distance(currentPosition, warehouse.Shelves[locations[i].shelf].shelfLocation());
+				if (steps != PATH_UNREACHABLE) {
+					stocked.push_back(std::make_pair(steps, i));
+				}
 			}
+			std::sort(stocked.begin(), stocked.end());
 
+			int needed = item.itemQuantity;
+			for (auto &s : stocked) {
+				if (needed <= 0) {
+					break;
+				}
+				const StockLocation &location = locations[s.second];
+				needed -= location.quantity;
+				Shelf *shelf = &warehouse.Shelves[location.shelf];
+				if (std::find(chosen.begin(), chosen.end(), shelf) == chosen.end()) {
+					chosen.push_back(shelf);
+				}
+			}
 		}
-		else if (memory_->winfo.maze[c - 1][r] == SHELF_CHAR)
-		{
-			Shelf shelf = findShelf((c-1), r, memory_);
-			for (auto &item : list) {
-				std::string name = item.itemName;
-				for (auto &inventory_item : shelf.inventory) {
-					std::string inventory_name = inventory_item.itemName;
-					if (name == inventory_name) {
-						shelf.releaseItem(item, holdingItems, item.itemQuantity);
+		return chosen;
+	}
+
+	/**
+	* Find's the shelf located at Coordinates [r, c]
+	* @param r row in the warehouse layout 
+	* @param c column in the warehouse layout 
+	* @return shelf at corresponding location [r,c], nullptr if there is none
+	*/
+	Shelf* findShelf(int c, int r) {
+		return warehouse.findShelf(Coordinates(r, c));
+	}
+
+	/**
+	* Obtains as much of each item still needed as the shelf has in stock
+	* and moves it into the robot holding items list
+	* @param shelf shelf next to the robot
+	* @param remaining items still to pick, reduced by what was picked
+	* @return number of items picked
+	*/
+	int pickup(Shelf &shelf, std::vector<Item> &remaining) {
+		std::lock_guard<decltype(mutex_)> mylock(mutex_);
+		int picked = 0;
+		for (auto &item : remaining) {
+			for (auto &inventory_item : shelf.inventory) {
+				if (item.itemQuantity > 0 && inventory_item.itemID == item.itemID) {
+					int quantity = std::min(item.itemQuantity, inventory_item.itemQuantity);
+					if (shelf.releaseItem(item, holdingItems, quantity)) {
+						item.itemQuantity -= quantity;
+						picked += quantity;
+						warehouse.recordPick(item.itemID);
 					}
+					break;
 				}
-
-			}
-			if (list == holdingItems) {
-				isFull = true;
 			}
 		}
+		return picked;
 	}
 
 	/**
-	* Finds shelf location to place item 
+	* Finds shelf location to place item, nearer the start and exit the more often
+	* it is picked.  Never searches more than once over the shelves.
 	* @param item item to be placed on the shelves
-	* @param winfo warehouse info stored in shared memory for accessing shelf inventory list
-	* @return coordinates able to hold item 
+	* @return coordinates able to hold item, (-1, -1) if no shelf has room
 	*/
-	Coordinates placeItem(Item item, WarehouseInfo winfo) {
-
-		// fill in random placements for items
-		std::default_random_engine rnd(
-			(unsigned int)std::chrono::system_clock::now().time_since_epoch().count());
-		std::uniform_int_distribution<size_t> rdist(0, winfo.rows);
-		std::uniform_int_distribution<size_t> cdist(0, winfo.cols);
-
-
-		bool heavy;
-
-			// generate until on shelf space
-			size_t r, c;
-			do {
-				r = rdist(rnd);
-				c = cdist(rnd);
-				Shelf shelf_ = findShelf(c, r, memory_);
-				heavy = false;
-				if (shelf_.shelfWeight + (item.itemWeight)*(item.itemQuantity) > MAX_SHELF_CAPACITY)
-				{
-					heavy = true;
-				}
-			} while (winfo.maze[c][r] != SHELF_CHAR || heavy == true);
-
-			Coordinates coord(r, c);
-			return coord;
+	Coordinates placeItem(Item item) {
+		std::lock_guard<decltype(mutex_)> mylock(mutex_);
+		Shelf* shelf = slotting_.placeItem(warehouse, item);
+		if (shelf == nullptr) {
+			return Coordinates(-1, -1);
+		}
+		return shelf->shelfLocation();
 	}
 
 	int main(void)
@@ -370,76 +428,47 @@ public:
 
 		updateCoordinates(currentPosition);
 
+		// sleep until there is work, then take the most urgent job:
+		// 1. delivery trucks, 2. restocking trucks, 3. picking orders
+		RobotJob job;
+		while (!memory_->quit && dispatcher_.next(job)) {
 
-		int truckNum = 0;
-
-		
-		int Num = order.getOrderNum();
-		int poisonNum = -1;
-
-
-		while (memory_->quit && memory_->magic == 1234) {
-			//TODO : Fix poison order
-			
-			/* 
-			Robot loops checking different queues:
-			1. Pick up queue
-			2. Truck queue
-			3. Delivery queue
-			*/
-
-			// 1. Pick up Queue
-			Order order = pickup_.removeFromPQueue();
-			if (order.getOrderNum() != -1) 
-			{
-				// process order
-				safe_printf("Robot %d starting order {%d}\n", id_, order.getOrderNum());
-				follow_path(order, memory_);
-				safe_printf("Robot %d completed order {%d}\n", id_, order.getOrderNum());
-
-				// add to those to serve
-				//delivery_.addToDQueue(order);
-				//TODO: update database!!!!!!!!!!
-
-				//move robot back to the start 
-				//moveToCoordinates(Coordinates(memory_->rinfo.startx, memory_->rinfo.starty));
-				// next order
-				Order order = pickup_.removeFromPQueue();
-				int poisonNum = POISON_ORDER.getOrderNum();
+			if (job.type == JOB_DELIVERY) {
+				safe_printf("Robot %d moving order {%d} to dock {%d}\n", id_, job.order.getOrderNum(), job.dockNumber);
+				moveToDock(job.dockNumber, [](size_t) {});
+				safe_printf("Robot %d completed order {%d}\n", id_, job.order.getOrderNum());
 			}
-
-			
-			// 2. Restock queue			
-			tCommand command = truck_.removeFromTQueue();
-			if (command.getOrder().getOrderNum() != -1)
-			{
-				truckNum = command.getTruckNum();
-				safe_printf("Robot %d moving order {%d} to truck number {%d}\n", id_, truckNum);
-				//follow_path(order, memory_);
-				safe_printf("Robot %d completed order {%d}\n", id_, Num);
-
-				// add to those to serve
-				//delivery_.addToDQueue(order);
-
-				//move robot back to the start 
-				moveToCoordinates(Coordinates(memory_->rinfo.startx, memory_->rinfo.starty));
-				// next order
-				order = pickup_.removeFromPQueue();
-
+			else if (job.type == JOB_RESTOCK) {
+				safe_printf("Robot %d unloading truck at dock {%d}\n", id_, job.dockNumber);
+				moveToDock(job.dockNumber, [&](size_t) {
+					unloadTruck(job.dockNumber);
+				});
+			}
+			else {
+				if (job.order.getOrderNum() == POISON_ORDER.getOrderNum()) {
+					break;
+				}
+				// process the order assigned to this robot, with any waiting orders worth picking on the same trip
+				std::vector<Order> wave = gatherWave(job.order);
+				for (auto &order : wave) {
+					safe_printf("Robot %d starting order {%d}\n", id_, order.getOrderNum());
+				}
+				follow_path(wave, memory_);
+
+				// hand over for delivery
+				holdingItems.clear();
+				isFull = false;
+				for (auto &order : wave) {
+					safe_printf("Robot %d completed order {%d}\n", id_, order.getOrderNum());
+					dispatcher_.picked(order);
+					completed_.addToDCQueue(std::move(order));
+				}
 			}
 
-			// 3. Delivery queue
-			/*
-			Order deliveryOrder = delivery_.removeFromDQueue();
-			if (deliveryOrder.getOrderNum() != -1) {
-				truckNum = 1;
-				safe_printf("Robot %d moving order {%d} to truck number {%d}\n", id_, truckNum);
-				moveToDock(truckNum);
-				safe_printf("Robot %d completed order {%d}\n", id_, Num);
-			}*/
-
+			//move robot back to the start 
+			moveToCoordinates(Coordinates(memory_->rinfo.startx, memory_->rinfo.starty));
 		}
-	
+
 		memory_->rinfo.nrobots = memory_->rinfo.nrobots + 1;
 		safe_printf("Robot %d finishing for the day\n", id_);
 		return 0;
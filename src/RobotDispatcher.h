@@ -0,0 +1,205 @@
+/**
+ * @file
+ *
+ * This contains the dispatcher handing work to the robots.  All of the robots' work
+ * queues post to a single WorkSignal, so an idle robot sleeps on that one wait point
+ * until there is something to do, then takes the most urgent job available:
+ *   1. loading a delivery truck waiting at a dock
+ *   2. unloading a restocking truck waiting at a dock
+ *   3. picking a customer order
+ * Trucks come first because they tie up a dock until the robots are done with them.
+ *
+ */
+#ifndef PROJECT_ROBOT_DISPATCHER_H
+#define PROJECT_ROBOT_DISPATCHER_H
+
+#include "WorkSignal.h"
+#include "PickupQueue.h"
+#include "AssignmentEngine.h"
+#include "RestockingQueue.h"
+#include "DeliveryTruckQueue.h"
+#include "WarehouseObjects.h"
+
+#include <utility>
+#include <vector>
+
+/**
+ * Kinds of robot jobs, in priority order
+ */
+enum RobotJobType {
+	JOB_DELIVERY,  // take an order to a delivery truck
+	JOB_RESTOCK,   // unload a restocking truck
+	JOB_PICKUP     // pick an order off the shelves
+};
+
+/**
+ * A unit of work for a robot
+ */
+struct RobotJob {
+	RobotJobType type;
+	Order order;       // order to pick or deliver
+	int dockNumber;    // dock of the truck, -1 for pickups
+
+	RobotJob() : type(JOB_PICKUP), order(-1), dockNumber(-1) {}
+};
+
+class RobotDispatcher {
+	PickupQueue& pickup_;
+	RestockingQueue& restock_;
+	DeliveryTruckQueue& delivery_;
+	WorkSignal signal_;
+	AssignmentEngine* engine_;
+
+	/**
+	* Takes the most urgent job queued
+	* @param job populated with the job
+	* @return true if a job was found
+	*/
+	bool take(RobotJob& job) {
+		tCommand delivery(Order(-1), -1);
+		if (delivery_.tryRemoveFromDTQueue(delivery)) {
+			job.type = JOB_DELIVERY;
+			job.order = std::move(delivery.getOrder());
+			job.dockNumber = delivery.getDockNumber();
+			return true;
+		}
+
+		trCommand restock(-1);
+		if (restock_.tryRemoveFromTQueue(restock)) {
+			job.type = JOB_RESTOCK;
+			job.order = Order(-1);
+			job.dockNumber = restock.getDockNumber();
+			return true;
+		}
+
+		Order order(-1);
+		if (pickup_.tryRemoveFromPQueue(order)) {
+			job.type = JOB_PICKUP;
+			job.order = std::move(order);
+			job.dockNumber = -1;
+			return true;
+		}
+		return false;
+	}
+
+public:
+	/**
+	* Constructor - dispatches work from the given queues.  Create it before any
+	* work is added, work queued earlier is not signalled.
+	* @param pickup queue of orders to pick
+	* @param restock queue of restocking trucks to unload
+	* @param delivery queue of orders to load onto delivery trucks
+	*/
+	RobotDispatcher(PickupQueue& pickup, RestockingQueue& restock, DeliveryTruckQueue& delivery) :
+		pickup_(pickup), restock_(restock), delivery_(delivery), signal_(), engine_(nullptr) {
+		pickup_.attach(signal_);
+		restock_.attach(signal_);
+		delivery_.attach(signal_);
+	}
+
+	RobotDispatcher(const RobotDispatcher&) = delete;
+	RobotDispatcher& operator=(const RobotDispatcher&) = delete;
+
+	/**
+	* Has robots pick the orders an assignment engine gives them instead of the
+	* oldest order.  Attach it before any orders are added.
+	* @param engine engine assigning orders to robots
+	*/
+	void attach(AssignmentEngine& engine) {
+		engine_ = &engine;
+	}
+
+	/**
+	* @return engine assigning orders to robots, nullptr to pick the oldest order first
+	*/
+	AssignmentEngine* engine() {
+		return engine_;
+	}
+
+	/**
+	* Waits for the next job, sleeping while there is none
+	* @param job populated with the most urgent job queued
+	* @return true if a job was assigned, false if the dispatcher was closed
+	*/
+	bool next(RobotJob& job) {
+		while (signal_.wait()) {
+			// every post matches one queued job, so this only fails if the job
+			// was taken directly from its queue
+			if (take(job)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/**
+	* Takes the next job if there is one, without waiting
+	* @param job populated with the most urgent job queued
+	* @return true if a job was assigned
+	*/
+	bool tryNext(RobotJob& job) {
+		while (signal_.tryWait()) {
+			if (take(job)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/**
+	* Takes orders waiting to be picked, for a robot to pick in a wave with its own
+	* @param max most orders to take
+	* @return orders taken, the order due soonest first
+	*/
+	std::vector<Order> takePickups(size_t max) {
+		std::vector<Order> orders;
+		Order order(-1);
+		while (orders.size() < max && pickup_.tryRemoveFromPQueue(order)) {
+			orders.push_back(std::move(order));
+		}
+		return orders;
+	}
+
+	/**
+	* Puts orders taken with takePickups but left out of a wave back in the pickup
+	* queue, as due as they were
+	* @param orders orders to put back
+	*/
+	void returnPickups(std::vector<Order> orders) {
+		if (!orders.empty()) {
+			pickup_.returnToPQueue(std::move(orders));
+		}
+	}
+
+	/**
+	* Records that a robot has picked an order, for the pickup queue's latency report
+	* @param order picked order
+	*/
+	void picked(const Order& order) {
+		pickup_.picked(order);
+	}
+
+	/**
+	* Latency of the orders picked so far, per service class
+	* @return a report for each class, most urgent first
+	*/
+	std::vector<SlaReport> slaReport() {
+		return pickup_.slaReport();
+	}
+
+	/**
+	* @return number of robots asleep waiting for a job
+	*/
+	size_t idleRobots() {
+		return signal_.waiting();
+	}
+
+	/**
+	* Stops dispatching, waking up every idle robot
+	*/
+	void close() {
+		signal_.close();
+	}
+};
+
+#endif //PROJECT_ROBOT_DISPATCHER_H
@@ -0,0 +1,122 @@
+/**
+ * @file
+ *
+ * This contains the route optimizer that decides the order a robot visits the
+ * shelves of an order in.
+ *
+ * Given the shelves to visit, where the robot starts and where it must finish,
+ * the optimizer first looks up the distance between every pair of stops in the
+ * path planner's distance fields and keeps them in a matrix, so the search below
+ * never has to route again. It then builds a tour by always going to the nearest
+ * unvisited shelf, and improves it with 2-opt: reversing any stretch of the tour
+ * that makes it shorter, until no reversal helps.
+ *
+ */
+#ifndef PROJECT_ROUTE_OPTIMIZER_H
+#define PROJECT_ROUTE_OPTIMIZER_H
+
+#include "PathPlanner.h"
+#include "WarehouseObjects.h"
+
+#include <algorithm>
+#include <vector>
+
+class RouteOptimizer {
+	const PathPlanner& planner_;
+
+public:
+	/**
+	* Constructor - optimizes routes over a planner's distances
+	* @param planner path planner of the warehouse, must outlive the optimizer
+	*/
+	RouteOptimizer(const PathPlanner& planner) : planner_(planner) {}
+
+	/**
+	* Finds a short order to visit a set of shelves in
+	* @param start where the robot is
+	* @param stops shelves to visit
+	* @param finish where the robot must end up, the exit or a dock
+	* @return indices into stops, in the order to visit them
+	*/
+	std::vector<size_t> plan(const Coordinates& start, const std::vector<Coordinates>& stops,
+		const Coordinates& finish) const {
+
+		// node 0 is the start, 1..n the stops, n+1 the finish
+		size_t n = stops.size();
+		std::vector<Coordinates> nodes;
+		nodes.reserve(n + 2);
+		nodes.push_back(start);
+		nodes.insert(nodes.end(), stops.begin(), stops.end());
+		nodes.push_back(finish);
+
+		// distances are symmetric, so only look up each pair once
+		std::vector<std::vector<int>> dist(n + 2, std::vector<int>(n + 2, 0));
+		for (size_t i = 0; i < n + 2; i++) {
+			for (size_t j = i + 1; j < n + 2; j++) {
+				dist[i][j] = dist[j][i] = planner_.distanceBetween(nodes[i], nodes[j]);
+			}
+		}
+
+		// nearest neighbour tour
+		std::vector<size_t> tour;
+		tour.reserve(n + 2);
+		tour.push_back(0);
+		std::vector<bool> visited(n + 2, false);
+		for (size_t k = 0; k < n; k++) {
+			size_t from = tour.back();
+			size_t next = 0;
+			for (size_t i = 1; i <= n; i++) {
+				if (!visited[i] && (next == 0 || dist[from][i] < dist[from][next])) {
+					next = i;
+				}
+			}
+			visited[next] = true;
+			tour.push_back(next);
+		}
+		tour.push_back(n + 1);
+
+		// 2-opt, keeping the start and finish in place
+		bool improved = true;
+		while (improved) {
+			improved = false;
+			for (size_t i = 1; i + 1 < tour.size(); i++) {
+				for (size_t j = i + 1; j + 1 < tour.size(); j++) {
+					long before = (long)dist[tour[i - 1]][tour[i]] + dist[tour[j]][tour[j + 1]];
+					long after = (long)dist[tour[i - 1]][tour[j]] + dist[tour[i]][tour[j + 1]];
+					if (after < before) {
+						std::reverse(tour.begin() + i, tour.begin() + j + 1);
+						improved = true;
+					}
+				}
+			}
+		}
+
+		std::vector<size_t> order;
+		order.reserve(n);
+		for (size_t i = 1; i <= n; i++) {
+			order.push_back(tour[i] - 1);
+		}
+		return order;
+	}
+
+	/**
+	* Number of steps to visit shelves in a given order
+	* @param start where the robot is
+	* @param stops shelves to visit
+	* @param order indices into stops, in the order visited
+	* @param finish where the robot ends up
+	* @return steps along the route
+	*/
+	long routeLength(const Coordinates& start, const std::vector<Coordinates>& stops,
+		const std::vector<size_t>& order, const Coordinates& finish) const {
+		long length = 0;
+		Coordinates at = start;
+		for (size_t i : order) {
+			length += planner_.distanceBetween(at, stops[i]);
+			at = stops[i];
+		}
+		return length + planner_.distanceBetween(at, finish);
+	}
+};
+
+#endif //PROJECT_ROUTE_OPTIMIZER_H
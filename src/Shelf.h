@@ -4,6 +4,9 @@
 #define MAX_SHELF_CAPACITY 200
 
 #include "WarehouseObjects.h"
+#include "StockIndex.h"
+#include "CapacityIndex.h"
+#include <algorithm>
 #include <vector>
 #include <list>
 #include <iostream>
@@ -11,6 +14,15 @@
 
 class Shelf
 {
+	StockIndex* stock_;         // warehouse index of where items are stocked, if any
+	CapacityIndex* capacity_;   // warehouse index of free capacity, if any
+	int slot_;                  // index of this shelf in the warehouse
+
+	void weightChanged() {
+		if (capacity_ != nullptr) {
+			capacity_->update(slot_, freeCapacity());
+		}
+	}
 
 public:
 	std::vector<Item> inventory;
@@ -22,33 +34,102 @@ public:
 	* @param newCoord, coordinates of shelf in warehouse layout
 	* @param capacity, maximum weight capacity for shelf (defaults to 200)
 	*/
-	Shelf(Coordinates newCoord, double capacity = MAX_SHELF_CAPACITY) : shelfCoordinates(newCoord) { shelfWeight = 0; }
+	Shelf(Coordinates newCoord, double capacity = MAX_SHELF_CAPACITY) : stock_(nullptr), capacity_(nullptr), slot_(-1), shelfCoordinates(newCoord) { shelfWeight = 0; }
+
+	// copies are not part of the warehouse, so they do not update its indexes
+	Shelf(const Shelf& other) : stock_(nullptr), capacity_(nullptr), slot_(-1), inventory(other.inventory),
+		shelfCoordinates(other.shelfCoordinates), shelfWeight(other.shelfWeight) {}
+
+	Shelf& operator=(const Shelf& other) {
+		stock_ = nullptr;
+		capacity_ = nullptr;
+		slot_ = -1;
+		inventory = other.inventory;
+		shelfCoordinates = other.shelfCoordinates;
+		shelfWeight = other.shelfWeight;
+		return *this;
+	}
+
+	/**
+	* Keeps a warehouse's stock and capacity indexes up to date with what is stored
+	* on the shelf
+	* @param stock stock index to update, nullptr to stop updating one
+	* @param capacity capacity index to update, nullptr to stop updating one
+	* @param slot index of this shelf in the warehouse
+	*/
+	void attach(StockIndex* stock, CapacityIndex* capacity, int slot) {
+		stock_ = stock;
+		capacity_ = capacity;
+		slot_ = slot;
+		weightChanged();
+	}
+
+	/**
+	* Weight the shelf can still take
+	* @return free capacity
+	*/
+	double freeCapacity() const {
+		return MAX_SHELF_CAPACITY - shelfWeight;
+	}
+
+	/**
+	* Number of units of an item the shelf has room for
+	* @param item item to store, by the weight of one unit
+	* @return units that fit
+	*/
+	int room(const Item& item) const {
+		if (item.itemWeight <= 0) {
+			return item.itemQuantity;
+		}
+		return std::max(0, (int)(freeCapacity() / item.itemWeight));
+	}
 
 	/**
 	* Stores item into shelf
-	* @param newItem, Item to store on the shelf 
+	* @param newItem, Item to store on the shelf, all of its units
 	* @return true if the item is succesfully stored on the shelf 
 	*/
 	bool storeItem(Item newItem) {
-		if (shelfWeight + newItem.itemWeight > MAX_SHELF_CAPACITY) {
+		double weight = newItem.itemWeight * newItem.itemQuantity;
+		if (shelfWeight + weight > MAX_SHELF_CAPACITY) {
 			return false;
 		}
 		else {
 			inventory.push_back(newItem);
-			shelfWeight += newItem.itemWeight;
+			shelfWeight += weight;
+			if (stock_ != nullptr) {
+				stock_->add(newItem.itemID, slot_, newItem.itemQuantity);
+			}
+			weightChanged();
 			return true;
 		}
 	}
 
 	/**
 	* Releases item from the shelf
-	* @param removedItem, Item to remove from the shelf
+	* @param removedItem, Item to remove from the shelf, found by its item ID
 	* @param newVector, new location of the item 
 	* @param quantity, number of products to remove from the shelf 
 	* @return true if the item is succesfully removed from the shelf
 	*/
 	bool releaseItem(Item removedItem, std::vector<Item> &newVector, int quantity) {
-		return MoveItem::moveItem(inventory, newVector, removedItem.itemName, quantity);
+		int itemID = removedItem.itemID;
+		double weight = removedItem.itemWeight;
+		for (auto &item : inventory) {
+			if (item.itemID == itemID) {
+				weight = item.itemWeight;
+				break;
+			}
+		}
+		if (!MoveItem::moveItem(inventory, newVector, itemID, quantity)) {
+			return false;
+		}
+		shelfWeight = std::max(0.0, shelfWeight - weight * quantity);
+		if (stock_ != nullptr) {
+			stock_->remove(itemID, slot_, quantity);
+		}
+		weightChanged();
+		return true;
 	}
 	
 	/**
@@ -0,0 +1,93 @@
+/**
+ * @file
+ *
+ * This contains the clock the robots keep time by.  Time is counted in ticks, the
+ * time a robot takes to move one cell.
+ *
+ * In real time, a tick lasts RESERVATION_TICK_MS divided by a scale factor, so a
+ * demo can run faster or slower than the robots would.  In virtual time the clock
+ * only moves when told to: a discrete-event simulation advances it straight to
+ * the next event, and sleeping just moves it forward, so a simulated day takes as
+ * long as the CPU needs to compute it.
+ *
+ */
+#ifndef PROJECT_SIM_CLOCK_H
+#define PROJECT_SIM_CLOCK_H
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#define RESERVATION_TICK_MS 100   // time for a robot to move one cell
+
+/**
+ * How a clock keeps time
+ */
+enum SimClockMode {
+	CLOCK_REAL_TIME,   // ticks pass on their own, scaled
+	CLOCK_VIRTUAL      // ticks pass only when the clock is advanced
+};
+
+class SimClock {
+	bool virtual_;
+	double scale_;                  // ticks run this many times faster than real time
+	std::chrono::steady_clock::time_point epoch_;
+	std::atomic<long> now_;         // current tick, in virtual time
+
+public:
+	/**
+	* Constructor - creates a clock starting at tick 0
+	* @param mode real or virtual time
+	* @param scale in real time, speed-up over the robots' real speed, e.g. 10 to
+	*        run ten times faster
+	*/
+	SimClock(SimClockMode mode = CLOCK_REAL_TIME, double scale = 1.0) :
+		virtual_(mode == CLOCK_VIRTUAL), scale_(scale > 0 ? scale : 1.0),
+		epoch_(std::chrono::steady_clock::now()), now_(0) {}
+
+	SimClock(const SimClock&) = delete;
+	SimClock& operator=(const SimClock&) = delete;
+
+	/**
+	* @return true if time only moves when advanced
+	*/
+	bool isVirtual() const {
+		return virtual_;
+	}
+
+	/**
+	* @return the current tick
+	*/
+	long now() const {
+		if (virtual_) {
+			return now_;
+		}
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - epoch_).count();
+		return (long)(ms * scale_ / RESERVATION_TICK_MS);
+	}
+
+	/**
+	* Waits until a tick starts.  In virtual time, moves the clock forward to it.
+	* @param tick tick to wait for
+	*/
+	void sleepUntil(long tick) {
+		if (virtual_) {
+			advanceTo(tick);
+			return;
+		}
+		std::this_thread::sleep_until(epoch_ + std::chrono::microseconds(
+			(long long)(tick * RESERVATION_TICK_MS * 1000.0 / scale_)));
+	}
+
+	/**
+	* Moves a virtual clock forward, never back
+	* @param tick tick to move to
+	*/
+	void advanceTo(long tick) {
+		long current = now_;
+		while (tick > current && !now_.compare_exchange_weak(current, tick)) {
+		}
+	}
+};
+
+#endif //PROJECT_SIM_CLOCK_H
@@ -0,0 +1,213 @@
+/**
+ * @file
+ *
+ * This contains the queue orders wait in to be picked, ordered by deadline.
+ *
+ * Every order belongs to a service class (SLA class) with a target: the ticks it
+ * should take from the order coming in to it being picked, e.g. express orders
+ * within 300 ticks, standard ones within 1500.  An order is due at its arrival
+ * plus its class's target, and the order due soonest is always handed out first,
+ * across all classes.  Within a class that is simply the oldest order first.
+ *
+ * Ordering by deadline also ages orders: an order's deadline never moves, while
+ * orders coming in later are due later.  Once an economy order has waited its
+ * target less the express target, it is due before any express order still to
+ * come in, so a steady stream of urgent orders can delay lower classes but never
+ * starve them.  Orders already late are handed out most overdue first.
+ *
+ * Picking an order means comparing the deadlines of every waiting order, so the
+ * queue is a heap behind a mutex rather than a lock-free ring.  Orders come in and
+ * are handed out at most a few times a second, and are moved in and out of the
+ * heap, never copied.
+ *
+ */
+#ifndef PROJECT_SLA_QUEUE_H
+#define PROJECT_SLA_QUEUE_H
+
+#include "WarehouseObjects.h"
+#include "LatencyStats.h"
+
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define SLA_DEFAULT_CLASS "standard"   // class of orders that do not ask for one
+
+/**
+ * A service class: a name customers order by, and how soon its orders are picked
+ */
+struct SlaClass {
+	std::string name;
+	long target;   // ticks from an order coming in to it being picked
+};
+
+/**
+ * Latency of the orders picked in a service class
+ */
+struct SlaReport {
+	SlaClass sla;
+	LatencySummary latency;   // ticks from coming in to being picked
+	long missed;              // orders picked after their target
+};
+
+/**
+ * @return the warehouse's service classes, most urgent first
+ */
+inline std::vector<SlaClass> defaultSlaClasses() {
+	return { { "express", 300 }, { "standard", 1500 }, { "economy", 6000 } };
+}
+
+class SlaQueue {
+	struct Entry {
+		long deadline;
+		long seq;      // keeps orders due at the same tick in the order they came in
+		Order order;
+	};
+
+	std::vector<SlaClass> classes_;
+	int default_;
+	std::mutex mutex_;
+	std::vector<Entry> heap_;
+	long seq_;
+	std::mutex statsMutex_;
+	std::vector<LatencyStats> latency_;
+	std::vector<long> missed_;
+
+	/**
+	* Heap order: the entry due soonest on top
+	*/
+	static bool later(const Entry& a, const Entry& b) {
+		return a.deadline != b.deadline ? a.deadline > b.deadline : a.seq > b.seq;
+	}
+
+	/**
+	* Checks an order's class, falling back to the default class
+	*/
+	int classOf(const Order& order) const {
+		int sla = order.getSlaClass();
+		return sla >= 0 && sla < (int)classes_.size() ? sla : default_;
+	}
+
+public:
+	/**
+	* Constructor - creates an empty queue
+	* @param classes service classes, most urgent first.  Orders without a class
+	*        belong to SLA_DEFAULT_CLASS if there is one, or else to the last class.
+	*/
+	SlaQueue(std::vector<SlaClass> classes = defaultSlaClasses()) : classes_(std::move(classes)), default_(0),
+		mutex_(), heap_(), seq_(0), statsMutex_(), latency_(), missed_() {
+		if (classes_.empty()) {
+			classes_ = defaultSlaClasses();
+		}
+		default_ = (int)classes_.size() - 1;
+		for (size_t i = 0; i < classes_.size(); i++) {
+			if (classes_[i].name == SLA_DEFAULT_CLASS) {
+				default_ = (int)i;
+			}
+		}
+		latency_.resize(classes_.size());
+		missed_.assign(classes_.size(), 0);
+	}
+
+	SlaQueue(const SlaQueue&) = delete;
+	SlaQueue& operator=(const SlaQueue&) = delete;
+
+	/**
+	* Looks up a service class by name
+	* @param name class name, empty for the default class
+	* @return index of the class, the default class if there is none by that name
+	*/
+	int find(const std::string& name) const {
+		for (size_t i = 0; i < classes_.size(); i++) {
+			if (classes_[i].name == name) {
+				return (int)i;
+			}
+		}
+		return default_;
+	}
+
+	/**
+	* @return the service classes, most urgent first
+	*/
+	const std::vector<SlaClass>& classes() const {
+		return classes_;
+	}
+
+	/**
+	* Adds an order coming in, due its class's target from now
+	* @param order order to add, moved into the queue
+	* @param now current tick
+	*/
+	void push(Order order, long now) {
+		int sla = classOf(order);
+		order.setSlaClass(sla);
+		order.schedule(now, now + classes_[sla].target);
+		restore(std::move(order));
+	}
+
+	/**
+	* Puts back an order taken without being picked, keeping its deadline
+	* @param order order to put back, moved into the queue
+	*/
+	void restore(Order order) {
+		long deadline = order.getDeadline();
+		std::lock_guard<std::mutex> lock(mutex_);
+		heap_.push_back(Entry{ deadline, seq_++, std::move(order) });
+		std::push_heap(heap_.begin(), heap_.end(), later);
+	}
+
+	/**
+	* Removes the order due soonest
+	* @param order populated with the removed order
+	* @return true if there was an order
+	*/
+	bool pop(Order& order) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (heap_.empty()) {
+			return false;
+		}
+		std::pop_heap(heap_.begin(), heap_.end(), later);
+		order = std::move(heap_.back().order);
+		heap_.pop_back();
+		return true;
+	}
+
+	/**
+	* Records that an order has been picked
+	* @param order picked order, taken from this queue
+	* @param now current tick
+	*/
+	void picked(const Order& order, long now) {
+		int sla = classOf(order);
+		std::lock_guard<std::mutex> lock(statsMutex_);
+		latency_[sla].record(now - order.getArrived());
+		if (now > order.getDeadline()) {
+			missed_[sla]++;
+		}
+	}
+
+	/**
+	* Latency of the orders picked so far, per class
+	* @return a report for each class, most urgent first
+	*/
+	std::vector<SlaReport> report() {
+		std::vector<SlaReport> reports;
+		std::lock_guard<std::mutex> lock(statsMutex_);
+		for (size_t i = 0; i < classes_.size(); i++) {
+			reports.push_back(SlaReport{ classes_[i], latency_[i].summary(), missed_[i] });
+		}
+		return reports;
+	}
+
+	/**
+	* @return number of waiting orders
+	*/
+	size_t size() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return heap_.size();
+	}
+};
+
+#endif //PROJECT_SLA_QUEUE_H
@@ -0,0 +1,418 @@
+/**
+ * @file
+ *
+ * This contains the slotting optimizer that decides which shelves items are
+ * stored on.
+ *
+ * A shelf's cost is the length of a robot trip picking from it alone: from the
+ * start to the shelf, then on to the exit.  The warehouse counts how often each
+ * item is picked, its velocity, and the optimizer keeps the fastest movers on the
+ * cheapest shelves, one item per shelf while there are shelves to spare:
+ *   - when the warehouse is stocked, items are slotted fastest first onto the
+ *     cheapest shelves, instead of round-robin over the layout
+ *   - a single item restocked later goes to a shelf ranked like its velocity, or
+ *     if it has never been picked, to the shelf it fits most tightly
+ *   - a background job periodically proposes moves that bring the layout back in
+ *     line with the velocities seen so far, with the predicted saving in travel
+ *
+ */
+#ifndef PROJECT_SLOTTING_OPTIMIZER_H
+#define PROJECT_SLOTTING_OPTIMIZER_H
+
+#include <cpen333/process/mutex.h>
+
+#include "WarehouseCommon.h"
+#include "Warehouse.h"
+#include "PathPlanner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#define SLOTTING_INTERVAL_S 60    // seconds between re-slotting proposals
+
+/**
+ * Stock to move from one shelf to another
+ */
+struct SlotMove {
+	int itemID;
+	InternedString itemName;
+	int quantity;
+	int from;       // index of the shelf in the warehouse
+	int to;
+	long saving;    // predicted steps saved by the item's picks so far, on its first move
+};
+
+/**
+ * Moves proposed by the optimizer and their effect on travel.  Travel is the
+ * steps of picking each item from its closest shelf, weighted by its picks.
+ */
+struct SlottingReport {
+	std::vector<SlotMove> moves;
+	long currentTravel;
+	long plannedTravel;
+
+	SlottingReport() : moves(), currentTravel(0), plannedTravel(0) {}
+};
+
+class SlottingOptimizer {
+	const PathPlanner& planner_;
+	Coordinates start_;
+	Coordinates exit_;
+
+	/**
+	* Stock of an item being slotted
+	*/
+	struct Sku {
+		int itemID;
+		long picks;
+		int shelf;     // cheapest shelf holding it
+		int cost;
+	};
+
+public:
+	/**
+	* Constructor - slots shelves by their distance from the robots' start and exit
+	* @param planner path planner of the warehouse, must outlive the optimizer
+	* @param rinfo robot start and exit locations
+	*/
+	SlottingOptimizer(const PathPlanner& planner, const RobotInfo& rinfo) :
+		planner_(planner), start_(rinfo.startx, rinfo.starty), exit_(rinfo.endx, rinfo.endy) {}
+
+	/**
+	* Steps in a trip picking from one shelf: start to the shelf, then to the exit
+	* @param shelf shelf location
+	* @return steps, PATH_UNREACHABLE if the shelf cannot be reached
+	*/
+	int cost(const Coordinates& shelf) const {
+		int there = planner_.distance(start_, shelf);
+		int out = planner_.distanceBetween(shelf, exit_);
+		if (there == PATH_UNREACHABLE || out == PATH_UNREACHABLE) {
+			return PATH_UNREACHABLE;
+		}
+		return there + out;
+	}
+
+	/**
+	* Ranks the shelves robots can reach
+	* @param warehouse warehouse to rank
+	* @return indexes of reachable shelves, cheapest first
+	*/
+	std::vector<int> rankShelves(Warehouse& warehouse) const {
+		std::vector<std::pair<int, int>> costs;
+		for (size_t i = 0; i < warehouse.Shelves.size(); i++) {
+			int c = cost(warehouse.Shelves[i].shelfLocation());
+			if (c != PATH_UNREACHABLE) {
+				costs.push_back(std::make_pair(c, (int)i));
+			}
+		}
+		std::sort(costs.begin(), costs.end());
+		std::vector<int> ranked;
+		ranked.reserve(costs.size());
+		for (auto& c : costs) {
+			ranked.push_back(c.second);
+		}
+		return ranked;
+	}
+
+	/**
+	* Stocks the warehouse, fastest items first onto the cheapest shelves, one item
+	* per shelf until every shelf holds one.  Items picked equally often go lightest
+	* first, so the cheapest shelves hold as many items as possible, and an item too
+	* heavy for one shelf is split over the next ones.
+	* @param warehouse warehouse to stock
+	* @param items items to store
+	* @return units that did not fit anywhere
+	*/
+	int slot(Warehouse& warehouse, std::vector<Item> items) const {
+		std::stable_sort(items.begin(), items.end(), [&warehouse](const Item& a, const Item& b) {
+			long pa = warehouse.picks(a.itemID);
+			long pb = warehouse.picks(b.itemID);
+			if (pa != pb) {
+				return pa > pb;
+			}
+			return a.itemWeight * a.itemQuantity < b.itemWeight * b.itemQuantity;
+		});
+		std::vector<int> ranked = rankShelves(warehouse);
+		int unplaced = 0;
+		size_t next = 0;
+		for (auto& item : items) {
+			int remaining = item.itemQuantity;
+			for (size_t tried = 0; tried < ranked.size() && remaining > 0; tried++) {
+				// no shelf left with room for even one unit
+				if (warehouse.mostFree() < item.itemWeight) {
+					break;
+				}
+				size_t at = (next + tried) % ranked.size();
+				Shelf& shelf = warehouse.Shelves[ranked[at]];
+				Item part = item;
+				part.itemQuantity = std::min(remaining, shelf.room(item));
+				if (part.itemQuantity > 0 && shelf.storeItem(part)) {
+					remaining -= part.itemQuantity;
+					if (remaining == 0) {
+						next = (at + 1) % ranked.size();
+					}
+				}
+			}
+			unplaced += remaining;
+		}
+		return unplaced;
+	}
+
+	/**
+	* Chooses a shelf for an item.  An item that has never been picked goes on the
+	* shelf it fits most tightly (best fit), keeping emptier shelves free.  Otherwise
+	* the n-th fastest item goes on or after the n-th cheapest shelf with room for it,
+	* falling back to cheaper shelves if none after it have room.
+	* @param warehouse warehouse to store in
+	* @param item item to store, all of its units
+	* @return shelf to store it on, nullptr if no shelf has room
+	*/
+	Shelf* placeItem(Warehouse& warehouse, const Item& item) const {
+		double weight = item.itemWeight * item.itemQuantity;
+		if (warehouse.mostFree() < weight) {
+			return nullptr;
+		}
+
+		long picks = warehouse.picks(item.itemID);
+		if (picks == 0) {
+			Shelf* shelf = warehouse.bestFit(weight);
+			if (shelf != nullptr && cost(shelf->shelfLocation()) != PATH_UNREACHABLE) {
+				return shelf;
+			}
+		}
+
+		// rank of the item among the items in stock
+		std::vector<int> ranked = rankShelves(warehouse);
+		std::vector<int> stocked;
+		for (auto& shelf : warehouse.Shelves) {
+			for (auto& held : shelf.inventory) {
+				stocked.push_back(held.itemID);
+			}
+		}
+		std::sort(stocked.begin(), stocked.end());
+		stocked.erase(std::unique(stocked.begin(), stocked.end()), stocked.end());
+		size_t rank = 0;
+		for (int id : stocked) {
+			if (id != item.itemID && warehouse.picks(id) > picks) {
+				rank++;
+			}
+		}
+		rank = std::min(rank, ranked.empty() ? 0 : ranked.size() - 1);
+
+		for (size_t i = rank; i < ranked.size(); i++) {
+			if (warehouse.Shelves[ranked[i]].freeCapacity() >= weight) {
+				return &warehouse.Shelves[ranked[i]];
+			}
+		}
+		for (size_t i = rank; i-- > 0;) {
+			if (warehouse.Shelves[ranked[i]].freeCapacity() >= weight) {
+				return &warehouse.Shelves[ranked[i]];
+			}
+		}
+		return nullptr;
+	}
+
+	/**
+	* Proposes moves putting the items picked most on the cheapest shelves.  Items
+	* are considered fastest first, each moving all of its stock to the cheapest
+	* shelf cheaper than its own with room for it, counting the room freed and taken
+	* by the moves before it.  Items never picked stay where they are.  Moves are
+	* listed in the order they must be made in.
+	* @param warehouse warehouse to re-slot
+	* @return moves and the predicted travel before and after them
+	*/
+	SlottingReport propose(Warehouse& warehouse) const {
+		SlottingReport report;
+
+		// every item in stock, with the cheapest shelf holding it
+		std::unordered_map<int, size_t> found;
+		std::vector<Sku> skus;
+		for (size_t i = 0; i < warehouse.Shelves.size(); i++) {
+			int c = cost(warehouse.Shelves[i].shelfLocation());
+			for (auto& held : warehouse.Shelves[i].inventory) {
+				auto it = found.find(held.itemID);
+				if (it == found.end()) {
+					found.emplace(held.itemID, skus.size());
+					Sku sku = { held.itemID, warehouse.picks(held.itemID), (int)i, c };
+					skus.push_back(sku);
+				}
+				else if (c < skus[it->second].cost) {
+					skus[it->second].shelf = (int)i;
+					skus[it->second].cost = c;
+				}
+			}
+		}
+		std::stable_sort(skus.begin(), skus.end(), [](const Sku& a, const Sku& b) {
+			return a.picks != b.picks ? a.picks > b.picks : a.cost < b.cost;
+		});
+
+		// weight each shelf will have free once the moves so far are made
+		std::vector<int> ranked = rankShelves(warehouse);
+		std::vector<double> free(warehouse.Shelves.size());
+		std::vector<int> costs(warehouse.Shelves.size());
+		for (size_t i = 0; i < warehouse.Shelves.size(); i++) {
+			free[i] = warehouse.Shelves[i].freeCapacity();
+			costs[i] = cost(warehouse.Shelves[i].shelfLocation());
+		}
+
+		for (auto& sku : skus) {
+			// all of its stock, to move together
+			std::vector<SlotMove> moves;
+			std::vector<double> weights;
+			double weight = 0;
+			for (auto& location : warehouse.stockOf(sku.itemID)) {
+				for (auto& held : warehouse.Shelves[location.shelf].inventory) {
+					if (held.itemID == sku.itemID) {
+						SlotMove move = { sku.itemID, held.itemName, location.quantity, location.shelf, -1, 0 };
+						moves.push_back(move);
+						weights.push_back(held.itemWeight * location.quantity);
+						weight += weights.back();
+						break;
+					}
+				}
+			}
+
+			int target = -1;
+			for (size_t i = 0; sku.picks > 0 && i < ranked.size() && costs[ranked[i]] < sku.cost; i++) {
+				if (free[ranked[i]] >= weight) {
+					target = ranked[i];
+					break;
+				}
+			}
+			int targetCost = target < 0 ? sku.cost : costs[target];
+			report.currentTravel += sku.picks * sku.cost;
+			report.plannedTravel += sku.picks * targetCost;
+			if (target < 0) {
+				continue;
+			}
+
+			free[target] -= weight;
+			for (size_t i = 0; i < moves.size(); i++) {
+				free[moves[i].from] += weights[i];
+				moves[i].to = target;
+			}
+			moves.front().saving = sku.picks * (sku.cost - targetCost);
+			report.moves.insert(report.moves.end(), moves.begin(), moves.end());
+		}
+		return report;
+	}
+
+	/**
+	* Carries out proposed moves.  Stock that no longer fits or was picked since the
+	* proposal stays where it is, so a move may only be made in part.
+	* @param warehouse warehouse to re-slot
+	* @param report moves to make
+	* @return number of moves made, in whole or in part
+	*/
+	int apply(Warehouse& warehouse, const SlottingReport& report) const {
+		int moved = 0;
+		for (auto& move : report.moves) {
+			Shelf& from = warehouse.Shelves[move.from];
+			Shelf& to = warehouse.Shelves[move.to];
+			Item item(move.itemName, move.itemID, move.quantity, 0);
+			for (auto& held : from.inventory) {
+				if (held.itemID == move.itemID) {
+					item.itemWeight = held.itemWeight;
+					break;
+				}
+			}
+			int quantity = std::min(move.quantity, to.room(item));
+			std::vector<Item> cart;
+			if (quantity <= 0 || !from.releaseItem(item, cart, quantity)) {
+				continue;
+			}
+			if (to.storeItem(cart.front())) {
+				moved++;
+			}
+			else {
+				from.storeItem(cart.front());
+			}
+		}
+		return moved;
+	}
+};
+
+/**
+ * Re-slotting proposals made in the background.  Every SLOTTING_INTERVAL_S the
+ * job looks at the velocities seen so far and keeps its latest proposal for the
+ * warehouse manager to review.
+ */
+class SlottingJob {
+	const SlottingOptimizer& optimizer_;
+	Warehouse& warehouse_;
+	std::mutex mutex_;
+	std::condition_variable changed_;
+	bool stopped_;
+	SlottingReport latest_;
+	std::thread thread_;
+
+	void run() {
+		cpen333::process::mutex warehouseMutex(WAREHOUSE_MUTEX_NAME);
+		std::unique_lock<std::mutex> lock(mutex_);
+		while (!changed_.wait_for(lock, std::chrono::seconds(SLOTTING_INTERVAL_S), [this]() { return stopped_; })) {
+			lock.unlock();
+			SlottingReport report;
+			{
+				std::lock_guard<decltype(warehouseMutex)> shelves(warehouseMutex);
+				report = optimizer_.propose(warehouse_);
+			}
+			lock.lock();
+			latest_ = report;
+		}
+	}
+
+public:
+	/**
+	* Constructor - starts proposing moves in the background
+	* @param optimizer optimizer to propose moves with, must outlive the job
+	* @param warehouse warehouse to re-slot, must outlive the job
+	*/
+	SlottingJob(const SlottingOptimizer& optimizer, Warehouse& warehouse) :
+		optimizer_(optimizer), warehouse_(warehouse), mutex_(), changed_(), stopped_(false), latest_(),
+		thread_(&SlottingJob::run, this) {}
+
+	SlottingJob(const SlottingJob&) = delete;
+	SlottingJob& operator=(const SlottingJob&) = delete;
+
+	~SlottingJob() {
+		stop();
+	}
+
+	/**
+	* @return the latest proposal, empty if none has been made yet
+	*/
+	SlottingReport latest() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return latest_;
+	}
+
+	/**
+	* Forgets the latest proposal, once it has been carried out
+	*/
+	void clear() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		latest_ = SlottingReport();
+	}
+
+	/**
+	* Stops the job, waiting for a proposal in progress
+	*/
+	void stop() {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stopped_ = true;
+		}
+		changed_.notify_all();
+		if (thread_.joinable()) {
+			thread_.join();
+		}
+	}
+};
+
+#endif //PROJECT_SLOTTING_OPTIMIZER_H
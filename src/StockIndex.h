@@ -0,0 +1,95 @@
+/**
+ * @file
+ *
+ * This contains the index of where each item is stocked: for every item ID, the
+ * shelves holding it and how many of it each one holds.  Shelves keep it up to
+ * date as items are stored on and released from them, so finding stock never
+ * means searching the shelves.
+ *
+ */
+#ifndef PROJECT_STOCK_INDEX_H
+#define PROJECT_STOCK_INDEX_H
+
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Stock of an item on one shelf
+ */
+struct StockLocation {
+	int shelf;      // index of the shelf in the warehouse
+	int quantity;   // units on that shelf
+};
+
+class StockIndex {
+	std::unordered_map<int, std::vector<StockLocation>> stock_;   // item ID to the shelves holding it
+
+public:
+	/**
+	* Records items stored on a shelf
+	* @param itemID item stored
+	* @param shelf index of the shelf in the warehouse
+	* @param quantity units stored
+	*/
+	void add(int itemID, int shelf, int quantity) {
+		if (quantity <= 0) {
+			return;
+		}
+		std::vector<StockLocation>& locations = stock_[itemID];
+		for (auto& location : locations) {
+			if (location.shelf == shelf) {
+				location.quantity += quantity;
+				return;
+			}
+		}
+		StockLocation location = { shelf, quantity };
+		locations.push_back(location);
+	}
+
+	/**
+	* Records items released from a shelf, dropping the shelf once it has none left
+	* @param itemID item released
+	* @param shelf index of the shelf in the warehouse
+	* @param quantity units released
+	*/
+	void remove(int itemID, int shelf, int quantity) {
+		auto it = stock_.find(itemID);
+		if (it == stock_.end()) {
+			return;
+		}
+		std::vector<StockLocation>& locations = it->second;
+		for (size_t i = 0; i < locations.size(); i++) {
+			if (locations[i].shelf == shelf) {
+				locations[i].quantity -= quantity;
+				if (locations[i].quantity <= 0) {
+					locations[i] = locations.back();
+					locations.pop_back();
+				}
+				break;
+			}
+		}
+		if (locations.empty()) {
+			stock_.erase(it);
+		}
+	}
+
+	/**
+	* Shelves holding an item, in no particular order
+	* @param itemID item to look up
+	* @return where the item is stocked, empty if it is out of stock
+	*/
+	const std::vector<StockLocation>& locations(int itemID) const {
+		static const std::vector<StockLocation> none;
+		auto it = stock_.find(itemID);
+		return it == stock_.end() ? none : it->second;
+	}
+
+	/**
+	* Forgets all stock
+	*/
+	void clear() {
+		stock_.clear();
+	}
+};
+
+#endif //PROJECT_STOCK_INDEX_H
@@ -4,11 +4,12 @@
 #include <iostream>
 #include <vector>
 #include <string>
-#include <deque>
-#include <mutex>
-#include <cpen333\thread\semaphore.h>
+#include <utility>
 
 #include "WarehouseObjects.h"
+#include "MpmcQueue.h"
+
+#define TRUCK_QUEUE_CAPACITY 256   // most truck commands waiting for robots
 
 class tCommand {
 	Order order;
@@ -39,49 +40,33 @@ public:
 };
 
 class TruckQueue {
-	std::deque<tCommand> truckQueue;
-	std::mutex mutex_;
-	std::condition_variable cv_;
-	cpen333::thread::semaphore truckSemaphore;
+	MpmcQueue<tCommand> truckQueue;
 
 public:
 	/**
 	* Constructor- creates a new empty truck queue
 	*/
-	TruckQueue() : truckSemaphore(0) { }
-	//TruckQueue(std::deque<tCommand> truckqueue) : truckQueue(truckqueue) {};
+	TruckQueue() : truckQueue(TRUCK_QUEUE_CAPACITY) { }
 
 
 	/**
-	* Adds to truck queue (instructions for robots)
+	* Adds to truck queue (instructions for robots), waiting for room if it is full
 	* @param command, command to be added to truck queue
 	*/
-	void addToTQueue(tCommand& command)
+	void addToTQueue(tCommand command)
 	{
-		mutex_.lock();
-		truckQueue.push_front(command);
-		mutex_.unlock();
-		truckSemaphore.notify();
+		truckQueue.push(std::move(command));
 	}
 
 
 	/**
 	* Removes from truck queue (instructions for robots)
-	* @return command to be added to be executed by robots
+	* @return command to be added to be executed by robots, order -1 if there is none
 	*/
 	tCommand removeFromTQueue(void) 
 	{
 		tCommand command(Order(-1));
-		std::unique_lock <std::mutex> lock(mutex_);
-		bool success = false;
-		success = truckSemaphore.try_wait();
-		// get first item in queue
-		if (success) {
-			command = truckQueue.front();
-			truckQueue.pop_front();
-			lock.unlock();
-		}	
-
+		truckQueue.try_pop(command);
 		return command;
 	}
 };
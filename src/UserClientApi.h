@@ -36,6 +36,23 @@ class UserClientApi {
    */
   virtual std::unique_ptr<Message> recvMessage() = 0;
 
+  /**
+   * Sends a request tagged with a new request ID, without waiting for the
+   * response, so several requests can be in flight at once
+   * @param msg request to write, its request ID is assigned
+   * @return request ID to wait for with recvResponse, 0 if error
+   */
+  virtual int sendRequest(Message& msg) = 0;
+
+  /**
+   * Waits for the response to a request sent with sendRequest.  Responses
+   * may arrive in any order: those to other requests are kept until asked for.
+   *
+   * @param requestId ID returned by sendRequest
+   * @return response message, nullptr if an error occurred
+   */
+  virtual std::unique_ptr<Message> recvResponse(int requestId) = 0;
+
 };
 
 #endif //LAB4_MUSIC_LIBRARY_API_H
@@ -2,8 +2,12 @@
 #define PROJECT_WAREHOUSE_H
 
 #include "Shelf.h"
+#include "StockIndex.h"
+#include "CapacityIndex.h"
 #include "WarehouseCommon.h"
 #include "WarehouseObjects.h"
+#include <algorithm>
+#include <unordered_map>
 #include <vector>
 #include <iostream>
 #include <string>
@@ -15,6 +19,45 @@
 
 class Warehouse
 {
+	int rows_;
+	int cols_;
+	std::vector<int> shelfAt_;   // index into Shelves of the shelf in each cell, row by row, -1 if none
+	StockIndex stock_;           // shelves holding each item, kept up to date by the shelves
+	CapacityIndex capacity_;     // free capacity of each shelf, kept up to date by the shelves
+	std::unordered_map<int, long> picks_;   // times each item has been picked
+
+	/**
+	* Rebuilds the grid of shelf indexes for a layout size
+	* @param rows rows in the warehouse layout
+	* @param cols columns in the warehouse layout
+	*/
+	void indexShelves(int rows, int cols) {
+		rows_ = rows;
+		cols_ = cols;
+		shelfAt_.assign((size_t)rows * cols, -1);
+		for (size_t i = 0; i < Shelves.size(); i++) {
+			Coordinates coord = Shelves[i].shelfLocation();
+			if (coord.XCoordinates >= 0 && coord.XCoordinates < rows && coord.YCoordinates >= 0 && coord.YCoordinates < cols) {
+				shelfAt_[coord.XCoordinates * cols + coord.YCoordinates] = (int)i;
+			}
+		}
+		indexStock();
+	}
+
+	/**
+	* Rebuilds the stock and capacity indexes from what is on the shelves, and has
+	* the shelves keep them up to date
+	*/
+	void indexStock() {
+		stock_.clear();
+		capacity_.clear();
+		for (size_t i = 0; i < Shelves.size(); i++) {
+			Shelves[i].attach(&stock_, &capacity_, (int)i);
+			for (auto &item : Shelves[i].inventory) {
+				stock_.add(item.itemID, (int)i, item.itemQuantity);
+			}
+		}
+	}
 	
 public:
 	std::vector <Shelf> Shelves;
@@ -24,8 +67,33 @@ public:
 	* Constructor- creates a new warehouse 
 	* @param Shelves_ a vector of shelves located within the warehouse
 	*/
-	Warehouse() : Shelves() {};
-	Warehouse(std::vector <Shelf> Shelves_) : Shelves(Shelves_) {};
+	Warehouse() : rows_(0), cols_(0), shelfAt_(), stock_(), capacity_(MAX_SHELF_CAPACITY), picks_(), Shelves() {};
+	Warehouse(std::vector <Shelf> Shelves_) : rows_(0), cols_(0), shelfAt_(), stock_(), capacity_(MAX_SHELF_CAPACITY), picks_(), Shelves(Shelves_) {
+		int rows = 0;
+		int cols = 0;
+		for (auto &shelf : Shelves) {
+			rows = std::max(rows, shelf.shelfLocation().XCoordinates + 1);
+			cols = std::max(cols, shelf.shelfLocation().YCoordinates + 1);
+		}
+		indexShelves(rows, cols);
+	};
+
+	// copies index their own shelves
+	Warehouse(const Warehouse& other) : rows_(other.rows_), cols_(other.cols_), shelfAt_(other.shelfAt_), stock_(), capacity_(MAX_SHELF_CAPACITY), picks_(other.picks_), Shelves(other.Shelves) {
+		indexStock();
+	}
+
+	Warehouse& operator=(const Warehouse& other) {
+		if (this != &other) {
+			rows_ = other.rows_;
+			cols_ = other.cols_;
+			shelfAt_ = other.shelfAt_;
+			picks_ = other.picks_;
+			Shelves = other.Shelves;
+			indexStock();
+		}
+		return *this;
+	}
 
 
 	/**
@@ -45,6 +113,85 @@ public:
 				}
 			}
 		}
+		indexShelves(rows, cols);
+	}
+
+	/**
+	* Finds the shelf in a cell of the warehouse layout
+	* @param coord cell to look in, [row, column]
+	* @return the shelf in that cell, nullptr if there is none
+	*/
+	Shelf* findShelf(const Coordinates& coord) {
+		if (coord.XCoordinates < 0 || coord.XCoordinates >= rows_ || coord.YCoordinates < 0 || coord.YCoordinates >= cols_) {
+			return nullptr;
+		}
+		int i = shelfAt_[coord.XCoordinates * cols_ + coord.YCoordinates];
+		return i < 0 ? nullptr : &Shelves[i];
+	}
+
+	/**
+	* Finds the shelves holding an item
+	* @param itemID item to look for
+	* @return index into Shelves of each shelf holding the item and how many it holds,
+	*         empty if the item is out of stock
+	*/
+	const std::vector<StockLocation>& stockOf(int itemID) const {
+		return stock_.locations(itemID);
+	}
+
+	/**
+	* Finds the shelf that fits a weight most tightly, leaving the emptier shelves
+	* for heavier items
+	* @param weight weight to store
+	* @return the fullest shelf with room for it, nullptr if none has room
+	*/
+	Shelf* bestFit(double weight) {
+		int i = capacity_.bestFit(weight);
+		return i < 0 ? nullptr : &Shelves[i];
+	}
+
+	/**
+	* @return free capacity of the emptiest shelf
+	*/
+	double mostFree() const {
+		return capacity_.mostFree();
+	}
+
+	/**
+	* @return how full the shelves are
+	*/
+	CapacityStats capacityStats() const {
+		return capacity_.stats();
+	}
+
+	/**
+	* Counts a pick of an item, for slotting
+	* @param itemID item picked
+	*/
+	void recordPick(int itemID) {
+		picks_[itemID]++;
+	}
+
+	/**
+	* @param itemID item to look up
+	* @return times the item has been picked
+	*/
+	long picks(int itemID) const {
+		auto it = picks_.find(itemID);
+		return it == picks_.end() ? 0 : it->second;
+	}
+
+	/**
+	* Finds where an item is stocked
+	* @param itemID item to look for
+	* @return coordinates of each shelf holding the item
+	*/
+	std::vector<Coordinates> locate(int itemID) {
+		std::vector<Coordinates> out;
+		for (auto &location : stock_.locations(itemID)) {
+			out.push_back(Shelves[location.shelf].shelfLocation());
+		}
+		return out;
 	}
 	
 	/**
@@ -9,16 +9,27 @@
 
 #include "WarehouseObjects.h"
 #include "Shelf.h"
+#include "InventorySearch.h"
 #include <vector>
 #include <set>
-#include <regex>
 #include <utility>
+#include <unordered_map>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <cpen333/thread/shared_mutex.h>
+
+// number of mutexes guarding item quantities, entries are assigned by item ID
+#define INVENTORY_LOCK_STRIPES 64
+// order number given to the first order, later ones count up from it
+#define FIRST_ORDER_NUM 1001
 
 #pragma region ItemEntries
 class ItemEntry {
 
 public:
-	std::string itemName;
+	InternedString itemName;
 	int ID;
 	double weight;
 	int quantityOnHold;
@@ -31,15 +42,15 @@ public:
 	* @param itemName_ name of item to create entry of 
 	* @param quantityAvailable_ quantity of item 
 	*/
-	ItemEntry(std::string itemName_, int quantityAvailable_) : itemName(itemName_), quantityAvailable(quantityAvailable_) { quantityOnHold = 0; }
+	ItemEntry(InternedString itemName_, int quantityAvailable_) : itemName(itemName_), quantityAvailable(quantityAvailable_) { quantityOnHold = 0; }
 	
 	/**
 	* Constructor- create an ItemEntry with a name, quantity available, item ID, and item weight
 	* @param item Item object of item in warehouse
 	* @param quantity quantity of item
 	*/
-	ItemEntry(Item item, int quantity) { itemName = item.itemName; ID = item.itemID; weight = item.itemWeight; 
-		quantityAvailable = quantity; quantityOnHold = 0; shelfLocations.push_back(Coordinates(0,0)); }
+	ItemEntry(const Item& item, int quantity) : itemName(item.itemName), ID(item.itemID), weight(item.itemWeight),
+		quantityOnHold(0), quantityAvailable(quantity) {}
 	
 	/**
 	* Constructor- create an ItemEntry with a name, quantity available, item ID, and item weight, and cost
@@ -49,7 +60,7 @@ public:
 	* @param weight weight of item
 	* @param cost cost of item 
 	*/
-	ItemEntry(std::string itemName_, int quantityAvailable_, int ID, double weight, int cost) : 
+	ItemEntry(InternedString itemName_, int quantityAvailable_, int ID, double weight, int cost) : 
 		itemName(itemName_), quantityAvailable(quantityAvailable_), ID(ID), weight(weight), cost(cost) {
 		quantityOnHold = 0;
 	}
@@ -80,8 +91,9 @@ public:
 		os << s.itemName << "\t\t" << s.ID << "\t" << s.quantityAvailable << "\t\t\t" << s.quantityOnHold << "\t\t\t";
 		bool first = true;
 		for (Coordinates &coord : s.shelfLocations) {
-			if (!first) { os << ", "; first = false; }
+			if (!first) { os << ", "; }
 			os << coord;
+			first = false;
 		}
 		return os;
 	}
@@ -94,18 +106,106 @@ class WarehouseInventory {
   // private vector
   std::vector<ItemEntry> inventory;
 
+  // secondary indexes into inventory, kept in sync on every insertion.  The
+  // catalog may list an ID more than once, so each ID keeps all its slots.
+  std::unordered_map<int, std::vector<size_t>> idIndex;
+  std::unordered_map<InternedString, size_t> nameIndex;
+  InventorySearch search;
+
+  /**
+  * Locks guarding the inventory.  The structure lock is held shared by every
+  * operation and exclusively only when a new entry is appended (which may move
+  * the vector and changes the indexes).  Quantities of an entry are guarded by
+  * the stripe for its item ID, so clients working on different SKUs do not block
+  * each other.
+  */
+  struct Locks {
+	  cpen333::thread::shared_mutex structure;
+	  std::mutex stripes[INVENTORY_LOCK_STRIPES];
+  };
+  std::unique_ptr<Locks> locks;
+
+  static size_t stripeIndex(int itemID) {
+	  return (unsigned int)itemID % INVENTORY_LOCK_STRIPES;
+  }
+
+  std::mutex& stripe(int itemID) const {
+	  return locks->stripes[stripeIndex(itemID)];
+  }
+
+  /**
+  * Records the slot of a newly appended entry in the ID and name indexes.
+  * Lookups of a single entry take the first one if the catalog contains
+  * duplicate IDs or names, matching the order the old linear scans visited
+  * them in, while searches by ID still return all of them.
+  * @param slot position of the entry in the inventory vector
+  */
+  void indexEntry(size_t slot) {
+	  idIndex[inventory[slot].ID].push_back(slot);
+	  nameIndex.emplace(inventory[slot].itemName, slot);
+	  search.insert(inventory[slot].itemName, slot);
+  }
+
+  /**
+  * Rebuilds both indexes from scratch
+  */
+  void reindex() {
+	  idIndex.clear();
+	  nameIndex.clear();
+	  search.clear();
+	  idIndex.reserve(inventory.size());
+	  nameIndex.reserve(inventory.size());
+	  for (size_t i = 0; i < inventory.size(); i++) {
+		  indexEntry(i);
+	  }
+  }
+
+  /**
+  * Looks up an entry by item ID
+  * @param itemID itemID associated with item
+  * @return pointer to entry, nullptr if not in inventory
+  */
+  ItemEntry* lookupID(int itemID) {
+	  auto it = idIndex.find(itemID);
+	  if (it == idIndex.end()) {
+		  return nullptr;
+	  }
+	  return &inventory[it->second.front()];
+  }
+
+  const ItemEntry* lookupID(int itemID) const {
+	  auto it = idIndex.find(itemID);
+	  if (it == idIndex.end()) {
+		  return nullptr;
+	  }
+	  return &inventory[it->second.front()];
+  }
+
+  /**
+  * Looks up an entry by exact item name
+  * @param name item name (case sensitive)
+  * @return pointer to entry, nullptr if not in inventory
+  */
+  ItemEntry* lookupName(InternedString name) {
+	  auto it = nameIndex.find(name);
+	  if (it == nameIndex.end()) {
+		  return nullptr;
+	  }
+	  return &inventory[it->second];
+  }
+
  public:
 
 	 /** 
 	 * Constructor - creates an empty warehouse inventory
 	 */
-	 WarehouseInventory() {};
+	 WarehouseInventory() : locks(new Locks()) {};
 
 	 /** 
 	 * Constructor - creates a warehouse with a vector of item entries
 	 * @param newEntries - vector of ItemEntry to store in warehouse inventory
 	 */
-	 WarehouseInventory(std::vector<ItemEntry> newEntries) : inventory(newEntries) {};
+	 WarehouseInventory(std::vector<ItemEntry> newEntries) : inventory(std::move(newEntries)), locks(new Locks()) { reindex(); };
 
   /**
    * Adds a item to the warehouse inventory
@@ -113,16 +213,27 @@ class WarehouseInventory {
    * @param quantity quantity of item to add 
    */
 	 void add(Item& item, int quantity) {
-		 bool found = false;
-		 for (ItemEntry &entry : inventory) {
-			 if (entry.itemName == item.itemName) {
-				 entry.quantityAvailable += quantity;
-				 found = true;
+		 {
+			 std::shared_lock<cpen333::thread::shared_mutex> structure(locks->structure);
+			 ItemEntry *entry = lookupName(item.itemName);
+			 if (entry != nullptr) {
+				 std::lock_guard<std::mutex> lock(stripe(entry->ID));
+				 entry->quantityAvailable += quantity;
+				 return;
 			 }
 		 }
+
 		 // make a new one if doesnt exist
-		 if (!found) {
+		 std::lock_guard<cpen333::thread::shared_mutex> structure(locks->structure);
+		 ItemEntry *entry = lookupName(item.itemName);
+		 if (entry != nullptr) {
+			 // added by another client since the shared lock was released
+			 std::lock_guard<std::mutex> lock(stripe(entry->ID));
+			 entry->quantityAvailable += quantity;
+		 }
+		 else {
 			 inventory.push_back(ItemEntry(item, quantity));
+			 indexEntry(inventory.size() - 1);
 		 }
 	 }
 
@@ -132,7 +243,10 @@ class WarehouseInventory {
    * @return number of items added
    */
   void add(std::vector<std::pair<Item, int>>& itempair) {
-    size_t count = 0;
+    {
+      std::lock_guard<cpen333::thread::shared_mutex> structure(locks->structure);
+      inventory.reserve(inventory.size() + itempair.size());
+    }
 
     for (auto& item : itempair) {
 		add(item.first, item.second);
@@ -146,19 +260,76 @@ class WarehouseInventory {
    * @return if successful
    */
   bool holdItem(int itemID, int quantity) {
-	  bool success = false;
-	  for (ItemEntry &entry : inventory) {
-		  //search if item exists in database
-		  if (entry.ID == itemID) {
-			  if (entry.quantityAvailable >= quantity) {
-				  entry.quantityAvailable -= quantity;
-				  entry.quantityOnHold += quantity;
-				  success = true;
-				  break;
-			  }
+	  std::shared_lock<cpen333::thread::shared_mutex> structure(locks->structure);
+	  ItemEntry *entry = lookupID(itemID);
+	  //search if item exists in database
+	  if (entry == nullptr) {
+		  return false;
+	  }
+	  std::lock_guard<std::mutex> lock(stripe(itemID));
+	  if (entry->quantityAvailable < quantity) {
+		  return false;
+	  }
+	  entry->quantityAvailable -= quantity;
+	  entry->quantityOnHold += quantity;
+	  return true;
+  }
+
+  /**
+   * Hold several items on stock at once: either every item is placed on hold
+   * or, if any of them is unknown or short, none are
+   * @param holds pairs of item ID # and number of reserved items
+   * @return if successful
+   */
+  bool holdItems(const std::vector<std::pair<int, int>>& holds) {
+	  std::shared_lock<cpen333::thread::shared_mutex> structure(locks->structure);
+
+	  std::vector<std::pair<ItemEntry*, int>> entries;
+	  std::vector<size_t> stripes;
+	  entries.reserve(holds.size());
+	  stripes.reserve(holds.size());
+	  for (auto& hold : holds) {
+		  ItemEntry *entry = lookupID(hold.first);
+		  if (entry == nullptr) {
+			  return false;
+		  }
+		  entries.push_back(std::make_pair(entry, hold.second));
+		  stripes.push_back(stripeIndex(hold.first));
+	  }
+
+	  // take the stripes in ascending order so overlapping batches can't deadlock
+	  std::sort(stripes.begin(), stripes.end());
+	  stripes.erase(std::unique(stripes.begin(), stripes.end()), stripes.end());
+	  std::vector<std::unique_lock<std::mutex>> held;
+	  held.reserve(stripes.size());
+	  for (size_t index : stripes) {
+		  held.emplace_back(locks->stripes[index]);
+	  }
+
+	  // the same item may be listed more than once, check the total wanted
+	  std::sort(entries.begin(), entries.end(), [](const std::pair<ItemEntry*, int>& a, const std::pair<ItemEntry*, int>& b) {
+		  return std::less<ItemEntry*>()(a.first, b.first);
+	  });
+	  size_t merged = 0;
+	  for (size_t i = 0; i < entries.size(); i++) {
+		  if (merged > 0 && entries[merged - 1].first == entries[i].first) {
+			  entries[merged - 1].second += entries[i].second;
+		  }
+		  else {
+			  entries[merged++] = entries[i];
 		  }
 	  }
-	  return success;
+	  entries.resize(merged);
+	  for (auto& entry : entries) {
+		  if (entry.first->quantityAvailable < entry.second) {
+			  return false;
+		  }
+	  }
+	  for (auto& entry : entries) {
+		  entry.first->quantityAvailable -= entry.second;
+		  entry.first->quantityOnHold += entry.second;
+	  }
+	  return true;
   }
 
   /**
@@ -169,21 +340,18 @@ class WarehouseInventory {
    * @return true if removed, false if not in library
    */
   bool remove(Item& item, int quantityonhold, int quantityavailable = 0) {
-	  bool success;
-	  for (ItemEntry &entry : inventory) {
-		  if (entry.itemName == item.itemName) {
-			  if (entry.quantityAvailable < quantityavailable || entry.quantityOnHold < quantityonhold) {
-				  success = false;
-			  }
-			  else {
-				  entry.quantityOnHold -= quantityonhold;
-				  entry.quantityAvailable -= quantityavailable;
-				  success = true;
-			  }
-		  }
+	  std::shared_lock<cpen333::thread::shared_mutex> structure(locks->structure);
+	  ItemEntry *entry = lookupName(item.itemName);
+	  if (entry == nullptr) {
+		  return false;
 	  }
-	  return success;
-	
+	  std::lock_guard<std::mutex> lock(stripe(entry->ID));
+	  if (entry->quantityAvailable < quantityavailable || entry->quantityOnHold < quantityonhold) {
+		  return false;
+	  }
+	  entry->quantityOnHold -= quantityonhold;
+	  entry->quantityAvailable -= quantityavailable;
+	  return true;
   }
 
   /**
@@ -194,15 +362,22 @@ class WarehouseInventory {
    */
   std::vector<ItemEntry> find(const std::string& name_regex, int itemID) const {
     std::vector<ItemEntry> out;
+    std::shared_lock<cpen333::thread::shared_mutex> structure(locks->structure);
 
-    // compile regular expressions
-    std::regex nregex(name_regex);
+    // names matching search expression, answered from the name index where possible
+    std::vector<size_t> slots = search.match(name_regex, inventory);
+    auto id = idIndex.find(itemID);
+    if (id != idIndex.end()) {
+      slots.insert(slots.end(), id->second.begin(), id->second.end());
+    }
 
-    // search through items for names matching search expression
-    for (auto& entry : inventory) {
-      if (std::regex_search(entry.itemName, nregex) || entry.ID == itemID) {
-        out.push_back(entry);
-      }
+    // return results in inventory order, each entry at most once
+    std::sort(slots.begin(), slots.end());
+    slots.erase(std::unique(slots.begin(), slots.end()), slots.end());
+    out.reserve(slots.size());
+    for (size_t slot : slots) {
+      std::lock_guard<std::mutex> lock(stripe(inventory[slot].ID));
+      out.push_back(inventory[slot]);
     }
 
     return out;
@@ -214,22 +389,43 @@ class WarehouseInventory {
   * @return item matching expression, else returns -1
   */
   ItemEntry find_id(int itemID) const {
-
-	  // search through items for names matching search expression
-	  for (auto& entry : inventory) {
-		  if (entry.ID == itemID) {
-			  return entry; 
-		  }
+	  std::shared_lock<cpen333::thread::shared_mutex> structure(locks->structure);
+	  const ItemEntry *entry = lookupID(itemID);
+	  if (entry != nullptr) {
+		  std::lock_guard<std::mutex> lock(stripe(itemID));
+		  return *entry;
 	  }
 	  return ItemEntry("empty", -1);
   }
 
+  /**
+  * Looks at the entry for an item ID in place, without copying it
+  * @param itemID itemID associated with item
+  * @param visit called with a const reference to the entry, which is only valid
+  *        during the call.  The entry is locked, so keep the call short and do not
+  *        call back into the inventory.
+  * @return true if the item is in the inventory
+  */
+  template<typename Visitor>
+  bool visit_id(int itemID, Visitor visit) const {
+	  std::shared_lock<cpen333::thread::shared_mutex> structure(locks->structure);
+	  const ItemEntry *entry = lookupID(itemID);
+	  if (entry == nullptr) {
+		  return false;
+	  }
+	  std::lock_guard<std::mutex> lock(stripe(itemID));
+	  visit(*entry);
+	  return true;
+  }
+
   /**
   * Prints the database
   */
   void printDatabase() {
+	  std::shared_lock<cpen333::thread::shared_mutex> structure(locks->structure);
 	  std::cout << "Item Name\tItemID\tQuantity Available\tQuantity on Hold\tShelf locations\tItem Weight" << std::endl;
 	  for (ItemEntry &entry : inventory) {
+		  std::lock_guard<std::mutex> lock(stripe(entry.ID));
 		  std::cout << entry << std::endl;
 	  }
 
@@ -237,7 +433,9 @@ class WarehouseInventory {
   
 
   /**
-   * Retrieves the unmodifiable list of items
+   * Retrieves the list of items.  Quantities may be modified through the
+   * reference, but entries must not be added or removed so the indexes stay valid.
+   * Access is not synchronized, only use while no clients are being serviced.
    * @return internal set of items
    */
   std::vector<ItemEntry> &items() {
@@ -260,27 +458,39 @@ public:
 	* @param orderNum order number
 	* @param items vector of ItemEntry 
 	*/
-	OrderEntry(int orderNum, std::vector<ItemEntry> items) : orderNum(orderNum), itemList(items) {}
+	OrderEntry(int orderNum, std::vector<ItemEntry> items) : orderNum(orderNum), itemList(std::move(items)) {}
 
 	/**
-	* Converts the vector of ItemEntry in an OrderEntry to a vector of Item
-	* @param order, OrderEntry containing vector of ItemEntry to be modified 
+	* Converts a vector of ItemEntry, e.g. the items of an OrderEntry, to a vector of Item
+	* @param items, entries of the items ordered, quantity ordered as the quantity available
 	* @return out, equivalent vector of Item
 	*/
-	std::vector<Item> entrytoitem(OrderEntry order) {
+	static std::vector<Item> entrytoitem(const std::vector<ItemEntry>& items) {
 		std::vector<Item> out;
-
-		for (int i = 0; i < order.itemList.size(); i++) {
-			Item item(order.itemList[i].itemName, order.itemList[i].ID, order.itemList[i].quantityAvailable, order.itemList[i].weight);
-			out.push_back(item);
+		out.reserve(items.size());
+		for (auto &entry : items) {
+			out.push_back(Item(entry.itemName, entry.ID, entry.quantityAvailable, entry.weight));
 		}
 		return out;
 	}
 };
 
 class OrderList {
-	std::vector<OrderEntry> orderList;
-	int orderID = 1001;
+	std::vector<OrderEntry> orderList;  // in order number order, from FIRST_ORDER_NUM
+	int orderID = FIRST_ORDER_NUM;
+	std::mutex mutex_;  // guards orderList and orderID, independent of the inventory locks
+
+	/**
+	* Looks up an order by number, call with the mutex held
+	* @param orderNum the orderID
+	* @return pointer to the order, nullptr if it doesn't exist
+	*/
+	OrderEntry* lookup(int orderNum) {
+		if (orderNum < FIRST_ORDER_NUM || orderNum >= orderID) {
+			return nullptr;
+		}
+		return &orderList[orderNum - FIRST_ORDER_NUM];
+	}
 public:
 
 	/**
@@ -294,8 +504,9 @@ public:
 	* @return unique order ID to identify the order
 	*/
 	int addEntry(std::vector<ItemEntry> itemList) {
+		std::lock_guard<std::mutex> lock(mutex_);
 		int ID = orderID;
-		orderList.push_back(OrderEntry(orderID, itemList));
+		orderList.push_back(OrderEntry(orderID, std::move(itemList)));
 		orderID++;
 		return ID;
 	}
@@ -307,14 +518,30 @@ public:
 	*		  if it doesn't exist, returns an order with an ID of -1
 	*/
 	OrderEntry searchOrder(int orderNum) {
-		for (auto &entry : orderList) {
-			if (entry.orderNum == orderNum) {
-				return entry;
-			}
+		std::lock_guard<std::mutex> lock(mutex_);
+		OrderEntry *entry = lookup(orderNum);
+		if (entry != nullptr) {
+			return *entry;
 		}
-		std::vector<ItemEntry> items;
-		return OrderEntry(-1, items);
+		return OrderEntry(-1, std::vector<ItemEntry>());
+	}
 
+	/**
+	* Looks at an order in place, without copying it
+	* @param orderNum the ID of the order
+	* @param visit called with a const reference to the order, which is only valid
+	*        during the call.  The order list is locked, so keep the call short.
+	* @return true if the order exists
+	*/
+	template<typename Visitor>
+	bool visitOrder(int orderNum, Visitor visit) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		OrderEntry *entry = lookup(orderNum);
+		if (entry == nullptr) {
+			return false;
+		}
+		visit((const OrderEntry&)*entry);
+		return true;
 	}
 
 	/**
@@ -324,15 +551,31 @@ public:
 	* @return true is successful, false if order doesn't exist
 	*/
 	bool changeStatus(int orderNum, std::string newStatus) {
-		bool success = false;
-		for (auto &entry : orderList) {
-			if (entry.orderNum == orderNum) {
-				entry.status = newStatus;
-				success = true;
-				break;
-			}
+		std::lock_guard<std::mutex> lock(mutex_);
+		OrderEntry *entry = lookup(orderNum);
+		if (entry == nullptr) {
+			return false;
+		}
+		entry->status = std::move(newStatus);
+		return true;
+	}
+
+	/**
+	* Change the status of an existing order only if it currently has the expected
+	* status, checking and updating under the same lock
+	* @param orderNum the orderID
+	* @param expectedStatus status the order must currently have
+	* @param newStatus string of order status
+	* @return true if changed, false if order doesn't exist or has a different status
+	*/
+	bool changeStatus(int orderNum, const std::string& expectedStatus, std::string newStatus) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		OrderEntry *entry = lookup(orderNum);
+		if (entry == nullptr || entry->status != expectedStatus) {
+			return false;
 		}
-		return success;
+		entry->status = std::move(newStatus);
+		return true;
 	}
 
 
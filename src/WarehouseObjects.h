@@ -1,9 +1,12 @@
 #ifndef PROJECT_WAREHOUSE_OBJECTS 
 #define PROJECT_WAREHOUSE_OBJECTS
 
+#include "InternedString.h"
+
 #include <iostream>
 #include <vector>
 #include <string>
+#include <utility>
 
 class Coordinates {
 
@@ -35,7 +38,7 @@ class Item {
 
 public:
 	int itemQuantity;
-	std::string itemName;
+	InternedString itemName;
 	int itemID;
 	double itemWeight;
 
@@ -46,7 +49,7 @@ public:
 	* @param quantity, quantity of item
 	* @param weight, weight of item 
 	*/
-	Item(std::string name, int ID, int quantity, double weight) : itemName(name), itemID(ID), itemQuantity(quantity), itemWeight(weight) {}
+	Item(InternedString name, int ID, int quantity, double weight) : itemQuantity(quantity), itemName(name), itemID(ID), itemWeight(weight) {}
 
 	// less-than operator for comparisons, sort by item id
 	friend bool operator<(const Item& a, const Item& b) {
@@ -73,6 +76,9 @@ public:
 
 class Order {
 	int orderNum;
+	int slaClass;    // service class in the pickup queue, -1 for its default class
+	long arrived;    // tick the order came into the pickup queue
+	long deadline;   // tick the order is due to be picked by
 
 public:
 	std::vector<Item> orderList;
@@ -80,34 +86,74 @@ public:
 	/**
 	* Constructor- create an empty Order
 	*/
-	Order(): orderNum(), orderList() {}
+	Order(): orderNum(), slaClass(-1), arrived(0), deadline(0), orderList() {}
 
 	/**
 	* Constructor- create an order containing a list of items 
 	* @param list,  list of items 
 	*/
-	Order(std::vector<Item> list) : orderList(list) {}
+	Order(std::vector<Item> list) : slaClass(-1), arrived(0), deadline(0), orderList(std::move(list)) {}
 
 	/**
 	* Constructor- create an order with an order number 
 	* @param num, order number associated with order 
 	*/
-	Order(int num) : orderNum(num) {}
+	Order(int num) : orderNum(num), slaClass(-1), arrived(0), deadline(0) {}
 
 	/**
 	* Constructor- create an order with an order number and order list
 	* @param list, list of items associated with order 
 	* @param num, order number associated with order
 	*/
-	Order(std::vector<Item> list, int num) : orderList(list), orderNum(num) {}
+	Order(std::vector<Item> list, int num) : orderNum(num), slaClass(-1), arrived(0), deadline(0), orderList(std::move(list)) {}
 
 	/**
 	* Returns the order's number
 	* @return order number
 	*/
-	int getOrderNum() {
+	int getOrderNum() const {
 		return orderNum; 
 	}
+
+	/**
+	* Returns the order's service class
+	* @return index of the class in the pickup queue, -1 for its default class
+	*/
+	int getSlaClass() const {
+		return slaClass;
+	}
+
+	/**
+	* Sets the order's service class
+	* @param sla, index of the class in the pickup queue
+	*/
+	void setSlaClass(int sla) {
+		slaClass = sla;
+	}
+
+	/**
+	* @return tick the order came into the pickup queue
+	*/
+	long getArrived() const {
+		return arrived;
+	}
+
+	/**
+	* @return tick the order is due to be picked by
+	*/
+	long getDeadline() const {
+		return deadline;
+	}
+
+	/**
+	* Stamps the order as it comes into the pickup queue
+	* @param tick, tick it came in
+	* @param due, tick it is due to be picked by
+	*/
+	void schedule(long tick, long due) {
+		arrived = tick;
+		deadline = due;
+	}
 	
 };
 
@@ -118,7 +164,7 @@ namespace MoveItem {
 	* PARAM:
 	*	fromVector	: the vector being transferred FROM
 	*	toVector	: vector of items being transferred TO. if the item doesn't exist in the new vector, it will be created
-	*	itemName	: name of the item (case sensitive)
+	*	itemID		: ID of the item
 	*	quantity	: how many items are being transferred
 	* RETURN:
 	*	bool	: true if transfer is successful
@@ -127,17 +173,17 @@ namespace MoveItem {
 	*	if fromVector's item would have zero quantity, it will be deleted from the vector
 	*/
 
-	bool moveItem(std::vector<Item> &fromVector, std::vector<Item> &toVector, std::string itemName, int quantity) {
+	bool moveItem(std::vector<Item> &fromVector, std::vector<Item> &toVector, int itemID, int quantity) {
 		bool success = false;
 
 		auto it = fromVector.begin();
 		for (auto &elem : fromVector) {
 
-			if (elem.itemName == itemName && elem.itemQuantity >= quantity) {
+			if (elem.itemID == itemID && elem.itemQuantity >= quantity) {
 				//check if item exists in tovector
 				bool alreadyExist = false;
 				for (auto &it : toVector) {
-					if (it.itemName == itemName) {
+					if (it.itemID == itemID) {
 						it.itemQuantity += quantity;
 						alreadyExist = true;
 					}
@@ -158,7 +204,7 @@ namespace MoveItem {
 				success = true;
 				break;
 			}
-			std::next(it); //next iterator
+			++it; //next iterator
 		}
 
 		return success;
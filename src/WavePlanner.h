@@ -0,0 +1,151 @@
+/**
+ * @file
+ *
+ * This contains the wave planner that groups customer orders into robot trips.
+ *
+ * A robot taking an order to pick also looks at the orders still waiting in the
+ * pickup queue, and picks some of them on the same trip: a wave.  Orders are added
+ * one at a time, always the one adding the fewest steps to the trip, so orders
+ * sharing shelves with the wave (which add no stops at all) or with shelves close
+ * to its route go first.  An order only joins if the robot can still carry it and
+ * picking it in the wave is shorter than a trip of its own, and only if the longer
+ * trip, at WAVE_TICKS_PER_STEP ticks per step, still ends before every order in
+ * the wave is due.  An
+ * express order is never held up by a long wave, while orders due later still
+ * share trips freely.  Orders left out go back to the queue for the next robot.
+ *
+ * Waves save steps but make each trip longer, so they only pay off when orders
+ * are waiting for robots.  The robot leaves one waiting order for each idle robot,
+ * which would otherwise have nothing to do, and never holds an order back waiting
+ * for others to join it.
+ *
+ */
+#ifndef PROJECT_WAVE_PLANNER_H
+#define PROJECT_WAVE_PLANNER_H
+
+#include "WarehouseCommon.h"
+#include "WarehouseObjects.h"
+#include "PathPlanner.h"
+#include "RouteOptimizer.h"
+
+#include <algorithm>
+#include <vector>
+
+#define WAVE_MAX_ORDERS 8       // most orders picked in one trip
+#define WAVE_CANDIDATES 32      // most waiting orders considered for a wave
+#define WAVE_TICKS_PER_STEP 3   // ticks allowed per step of a trip when checking deadlines, robots wait for each other in busy aisles
+
+/**
+ * What the wave planner needs to know about an order
+ */
+struct WaveOrder {
+	std::vector<Coordinates> shelves;   // shelves to pick it from
+	double weight;                      // weight of its items
+	long slack;                         // ticks before it is due, negative once it is late
+};
+
+class WavePlanner {
+	RouteOptimizer optimizer_;
+	Coordinates start_;
+	Coordinates exit_;
+	double capacity_;
+
+	/**
+	* Adds shelves to a list of stops, skipping ones already on it
+	*/
+	static void merge(std::vector<Coordinates>& stops, const std::vector<Coordinates>& shelves) {
+		for (auto& shelf : shelves) {
+			bool listed = false;
+			for (auto& stop : stops) {
+				if (stop.XCoordinates == shelf.XCoordinates && stop.YCoordinates == shelf.YCoordinates) {
+					listed = true;
+					break;
+				}
+			}
+			if (!listed) {
+				stops.push_back(shelf);
+			}
+		}
+	}
+
+public:
+	/**
+	* Constructor - plans waves for robots starting and finishing at the depots
+	* @param planner path planner of the warehouse, must outlive the wave planner
+	* @param rinfo robot start and exit locations
+	* @param capacity weight a robot can carry
+	*/
+	WavePlanner(const PathPlanner& planner, const RobotInfo& rinfo, double capacity = MAX_ROBOT_CAPACITY) :
+		optimizer_(planner), start_(rinfo.startx, rinfo.starty), exit_(rinfo.endx, rinfo.endy),
+		capacity_(capacity) {}
+
+	/**
+	* Steps in a trip from the start through shelves to the exit, in the order the
+	* route optimizer would visit them
+	* @param stops shelves to visit
+	* @return steps
+	*/
+	long tripLength(const std::vector<Coordinates>& stops) const {
+		return optimizer_.routeLength(start_, stops, optimizer_.plan(start_, stops, exit_), exit_);
+	}
+
+	/**
+	* Chooses waiting orders to pick on the same trip as a first order
+	* @param first order the robot is picking
+	* @param candidates orders waiting to be picked
+	* @param idle robots with nothing to do, one candidate is left for each
+	* @return indexes of the candidates to pick in the wave, in the order chosen
+	*/
+	std::vector<size_t> plan(const WaveOrder& first, const std::vector<WaveOrder>& candidates, size_t idle = 0) const {
+		std::vector<size_t> chosen;
+		if (candidates.size() <= idle) {
+			return chosen;
+		}
+		size_t most = std::min((size_t)WAVE_MAX_ORDERS - 1, candidates.size() - idle);
+		std::vector<Coordinates> stops;
+		merge(stops, first.shelves);
+		double weight = first.weight;
+		long length = tripLength(stops);
+		long due = first.slack;
+
+		// trips each candidate would take on its own
+		std::vector<long> alone(candidates.size());
+		for (size_t i = 0; i < candidates.size(); i++) {
+			alone[i] = tripLength(candidates[i].shelves);
+		}
+
+		std::vector<bool> taken(candidates.size(), false);
+		while (chosen.size() < most) {
+			size_t best = candidates.size();
+			long bestAdded = 0;
+			long bestLength = 0;
+			for (size_t i = 0; i < candidates.size(); i++) {
+				if (taken[i] || weight + candidates[i].weight > capacity_) {
+					continue;
+				}
+				std::vector<Coordinates> joined = stops;
+				merge(joined, candidates[i].shelves);
+				long joinedLength = joined.size() == stops.size() ? length : tripLength(joined);
+				long added = joinedLength - length;
+				bool onTime = added == 0 || joinedLength * WAVE_TICKS_PER_STEP <= std::min(due, candidates[i].slack);
+				if (added < alone[i] && onTime && (best == candidates.size() || added < bestAdded)) {
+					best = i;
+					bestAdded = added;
+					bestLength = joinedLength;
+				}
+			}
+			if (best == candidates.size()) {
+				break;
+			}
+			taken[best] = true;
+			chosen.push_back(best);
+			merge(stops, candidates[best].shelves);
+			weight += candidates[best].weight;
+			length = bestLength;
+			due = std::min(due, candidates[best].slack);
+		}
+		return chosen;
+	}
+};
+
+#endif //PROJECT_WAVE_PLANNER_H
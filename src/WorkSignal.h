@@ -0,0 +1,88 @@
+/**
+ * @file
+ *
+ * This contains the signal shared by the robots' work queues.  Every queue it is
+ * attached to posts to it when work is added, so a robot can sleep on one signal
+ * until any of its queues has something to do, instead of polling each queue.
+ *
+ */
+#ifndef PROJECT_WORK_SIGNAL_H
+#define PROJECT_WORK_SIGNAL_H
+
+#include <mutex>
+#include <condition_variable>
+
+class WorkSignal {
+	std::mutex mutex_;
+	std::condition_variable cv_;
+	size_t pending_;   // posts not yet taken by a waiter
+	size_t waiting_;   // waiters asleep
+	bool closed_;
+
+public:
+	/**
+	* Constructor - creates a signal with no pending work
+	*/
+	WorkSignal() : mutex_(), cv_(), pending_(0), waiting_(0), closed_(false) {}
+
+	/**
+	* Records that one piece of work was added and wakes up one waiter
+	*/
+	void post() {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			pending_++;
+		}
+		cv_.notify_one();
+	}
+
+	/**
+	* Waits until work has been posted, taking one post
+	* @return true if a post was taken, false if the signal was closed
+	*/
+	bool wait() {
+		std::unique_lock<std::mutex> lock(mutex_);
+		waiting_++;
+		cv_.wait(lock, [this] { return closed_ || pending_ > 0; });
+		waiting_--;
+		if (closed_) {
+			return false;
+		}
+		pending_--;
+		return true;
+	}
+
+	/**
+	* @return number of waiters asleep waiting for work
+	*/
+	size_t waiting() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return waiting_;
+	}
+
+	/**
+	* Takes one post if there is one, without waiting
+	* @return true if a post was taken
+	*/
+	bool tryWait() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (closed_ || pending_ == 0) {
+			return false;
+		}
+		pending_--;
+		return true;
+	}
+
+	/**
+	* Wakes up every waiter and makes all future waits fail
+	*/
+	void close() {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			closed_ = true;
+		}
+		cv_.notify_all();
+	}
+};
+
+#endif //PROJECT_WORK_SIGNAL_H
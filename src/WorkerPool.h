@@ -0,0 +1,133 @@
+/**
+ * @file
+ *
+ * This contains the pool of worker threads that handle client requests.  Requests are
+ * admitted through a bounded queue: when it is full the request is rejected right away
+ * so the caller can tell the client the server is busy, instead of the backlog growing
+ * until the server runs out of memory.
+ *
+ */
+#ifndef PROJECT_WORKER_POOL_H
+#define PROJECT_WORKER_POOL_H
+
+#include "BoundedQueue.h"
+
+#include <atomic>
+#include <functional>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// default number of requests waiting for a worker
+#define WORKER_QUEUE_CAPACITY 1024
+
+/**
+ * Snapshot of the pool's counters
+ */
+struct WorkerPoolStats {
+	size_t workers;
+	size_t queueDepth;      // requests waiting for a worker
+	size_t queueCapacity;
+	size_t peakDepth;       // deepest the queue has been
+	size_t accepted;
+	size_t rejected;        // turned away because the queue was full
+	size_t completed;
+};
+
+class WorkerPool {
+	BoundedQueue<std::function<void()>> jobs_;
+	std::vector<std::thread> threads_;
+	std::atomic<size_t> accepted_;
+	std::atomic<size_t> rejected_;
+	std::atomic<size_t> completed_;
+	std::atomic<size_t> peakDepth_;
+
+	/**
+	* Main function of each worker thread
+	*/
+	void work() {
+		std::function<void()> job;
+		while (jobs_.pop(job)) {
+			try {
+				job();
+			}
+			catch (std::exception& e) {
+				std::cerr << "Worker failed to handle request: " << e.what() << std::endl;
+			}
+			completed_++;
+		}
+	}
+
+public:
+	/**
+	* Constructor - starts the worker threads
+	* @param nworkers number of worker threads, defaults to one per hardware thread
+	* @param capacity number of requests allowed to wait for a worker
+	*/
+	WorkerPool(size_t nworkers = 0, size_t capacity = WORKER_QUEUE_CAPACITY) :
+		jobs_(capacity), threads_(), accepted_(0), rejected_(0), completed_(0), peakDepth_(0) {
+		if (nworkers == 0) {
+			nworkers = std::thread::hardware_concurrency();
+		}
+		if (nworkers == 0) {
+			nworkers = 4;
+		}
+		for (size_t i = 0; i < nworkers; i++) {
+			threads_.push_back(std::thread(&WorkerPool::work, this));
+		}
+	}
+
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+
+	~WorkerPool() {
+		shutdown();
+	}
+
+	/**
+	* Queues a request for a worker without waiting
+	* @param job function handling the request
+	* @return true if admitted, false if the queue is full and the request was rejected
+	*/
+	bool trySubmit(std::function<void()> job) {
+		if (!jobs_.try_push(std::move(job))) {
+			rejected_++;
+			return false;
+		}
+		accepted_++;
+
+		size_t depth = jobs_.size();
+		size_t peak = peakDepth_;
+		while (depth > peak && !peakDepth_.compare_exchange_weak(peak, depth)) {}
+		return true;
+	}
+
+	/**
+	* Lets the workers finish queued requests, then stops them
+	*/
+	void shutdown() {
+		jobs_.close();
+		for (auto& thread : threads_) {
+			if (thread.joinable()) {
+				thread.join();
+			}
+		}
+	}
+
+	/**
+	* Retrieves the current counters
+	*/
+	WorkerPoolStats stats() {
+		WorkerPoolStats out;
+		out.workers = threads_.size();
+		out.queueDepth = jobs_.size();
+		out.queueCapacity = jobs_.capacity();
+		out.peakDepth = peakDepth_;
+		out.accepted = accepted_;
+		out.rejected = rejected_;
+		out.completed = completed_;
+		return out;
+	}
+};
+
+#endif //PROJECT_WORKER_POOL_H
@@ -0,0 +1,115 @@
+/**
+* Measures how fast search responses are encoded and decoded: the JSON encoding
+* (JsonConverter and nlohmann::json) against the compact binary encoding
+* (BinaryConverter).  Each run encodes a SEARCH_RESPONSE holding a number of item
+* entries into the payload of a frame, the way the server sends it, and decodes
+* the payload back into a message, the way the client receives it.
+*
+* Usage: codecBenchmark [options]
+*   --entries <n>    total item entries encoded and decoded per run (default 200000)
+*   --results <n>    entries in each response (default: compare 1 up to 1000)
+*/
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "WarehouseInventory.h"
+#include "Message.h"
+#include "JsonConverter.h"
+#include "BinaryConverter.h"
+
+#define BENCH_ENTRIES 200000
+
+/**
+* Encodes and decodes a response repeatedly in one encoding
+* @param response response to encode
+* @param binary use the binary encoding instead of JSON
+* @param repeats times to encode and decode it
+* @param bytes populated with the size of the encoded response
+* @param encodeUs populated with the microseconds taken per encode
+* @param decodeUs populated with the microseconds taken per decode
+* @return true if every payload decoded back into a response with all its entries
+*/
+bool run(const SearchResponseMessage& response, bool binary, long repeats,
+	size_t& bytes, double& encodeUs, double& decodeUs) {
+
+	std::string payload;
+	auto start = std::chrono::steady_clock::now();
+	for (long i = 0; i < repeats; i++) {
+		if (binary) {
+			payload.clear();
+			BinaryConverter::encode(response, payload);
+		}
+		else {
+			payload = JsonConverter::toJSON(response).dump();
+		}
+	}
+	auto encoded = std::chrono::steady_clock::now();
+
+	bool good = true;
+	for (long i = 0; i < repeats; i++) {
+		std::unique_ptr<Message> msg;
+		if (binary) {
+			msg = BinaryConverter::decode(payload.data(), payload.size());
+		}
+		else {
+			msg = JsonConverter::parseMessage(JSON::parse(payload));
+		}
+		good = good && msg != nullptr && msg->type() == MessageType::SEARCH_RESPONSE &&
+			((SearchResponseMessage&)*msg).results.size() == response.results.size();
+	}
+	auto decoded = std::chrono::steady_clock::now();
+
+	bytes = payload.size();
+	encodeUs = std::chrono::duration<double, std::micro>(encoded - start).count() / repeats;
+	decodeUs = std::chrono::duration<double, std::micro>(decoded - encoded).count() / repeats;
+	return good;
+}
+
+int main(int argc, char* argv[]) {
+
+	long entries = BENCH_ENTRIES;
+	int nresults = 0;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--entries" && i + 1 < argc && std::atol(argv[i + 1]) > 0) {
+			entries = std::atol(argv[++i]);
+		}
+		else if (arg == "--results" && i + 1 < argc && std::atoi(argv[i + 1]) > 0) {
+			nresults = std::atoi(argv[++i]);
+		}
+	}
+
+	std::cout << entries << " item entries per run" << std::endl;
+	std::cout << "results\tJSON bytes\tbinary bytes\tJSON encode us\tbinary encode us\tJSON decode us\tbinary decode us\t"
+		"encode speedup\tdecode speedup" << std::endl;
+
+	std::vector<int> counts = { 1, 10, 100, 1000 };
+	if (nresults > 0) {
+		counts.assign(1, nresults);
+	}
+	for (int n : counts) {
+		std::vector<ItemEntry> results;
+		for (int i = 0; i < n; i++) {
+			results.push_back(ItemEntry("Catalog item number " + std::to_string(i), 10 + i, 1000 + i, 1.5, 25));
+		}
+		SearchResponseMessage response(std::move(results), MESSAGE_STATUS_OK);
+
+		long repeats = entries / n > 0 ? entries / n : 1;
+		size_t jsonBytes, binaryBytes;
+		double jsonEncode, jsonDecode, binaryEncode, binaryDecode;
+		bool good = run(response, false, repeats, jsonBytes, jsonEncode, jsonDecode);
+		good = run(response, true, repeats, binaryBytes, binaryEncode, binaryDecode) && good;
+		if (!good) {
+			std::cout << "Responses of " << n << " entries did not decode" << std::endl;
+			return 1;
+		}
+		std::cout << n << "\t" << jsonBytes << "\t" << binaryBytes << "\t" << jsonEncode << "\t" << binaryEncode << "\t"
+			<< jsonDecode << "\t" << binaryDecode << "\t" << jsonEncode / binaryEncode << "\t" << jsonDecode / binaryDecode << std::endl;
+	}
+
+	return 0;
+}
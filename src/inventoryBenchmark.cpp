@@ -0,0 +1,130 @@
+/**
+* Measures how the server's inventory and order list scale with the number of
+* clients served at once.  Each client thread runs what a shopper's requests do
+* in handleMessage: it searches for an item by name, holds a cart of a few items,
+* confirms the order and checks on it.  The same requests are run once behind a
+* single server-wide mutex, the way every client was serialized on Server_Mutex,
+* and once with only the inventory's per-SKU locks and the order list's lock.
+* The rate is counted in requests per second.
+*
+* Usage: inventoryBenchmark [options]
+*   --carts <n>      carts checked out in each run, shared by the clients (default 100000)
+*   --skus <n>       items in the catalog (default 1000)
+*   --clients <n>    clients served at once (default: compare 1 up to 64)
+*/
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "WarehouseObjects.h"
+#include "WarehouseInventory.h"
+
+#define BENCH_CARTS 100000
+#define BENCH_SKUS 1000
+#define BENCH_CART_ITEMS 3
+#define BENCH_REQUESTS_PER_CART 4   // search, hold, confirm and check
+
+/**
+* Runs the clients' requests, each under a lock
+* @param skus items in the catalog
+* @param clients clients served at once
+* @param carts carts checked out altogether
+* @param serialize lock a server-wide mutex around every request
+* @return requests per second
+*/
+double run(int skus, int clients, long carts, bool serialize) {
+	std::vector<ItemEntry> catalog;
+	for (int i = 0; i < skus; i++) {
+		catalog.push_back(ItemEntry("Catalog item " + std::to_string(i), 1000000000, i, 1.0, 10));
+	}
+	WarehouseInventory lib(std::move(catalog));
+	OrderList orderList;
+	std::mutex serverMutex;
+
+	// a lock on the server mutex, or no lock at all
+	auto request = [&serverMutex, serialize]() {
+		return serialize ? std::unique_lock<std::mutex>(serverMutex) : std::unique_lock<std::mutex>();
+	};
+
+	std::vector<std::thread> workers;
+	auto start = std::chrono::steady_clock::now();
+	for (int c = 0; c < clients; c++) {
+		long share = carts / clients + (c < carts % clients ? 1 : 0);
+		workers.push_back(std::thread([&lib, &orderList, &request, skus, share, c]() {
+			unsigned int seed = 12345u + c;
+			std::vector<std::pair<int, int>> holds;
+			for (long n = 0; n < share; n++) {
+				holds.clear();
+				std::vector<ItemEntry> cart;
+				for (int i = 0; i < BENCH_CART_ITEMS; i++) {
+					seed = seed * 1103515245u + 12345u;
+					int id = (int)((seed >> 8) % (unsigned int)skus);
+					holds.push_back(std::make_pair(id, 1));
+					cart.push_back(ItemEntry("", 1, id, 1.0, 0));
+				}
+				{
+					auto lock = request();
+					lib.find("^Catalog item " + std::to_string(holds[0].first) + "$", -1);
+				}
+				{
+					auto lock = request();
+					lib.holdItems(holds);
+				}
+				int orderNum;
+				{
+					auto lock = request();
+					orderNum = orderList.addEntry(std::move(cart));
+				}
+				{
+					auto lock = request();
+					orderList.searchOrder(orderNum);
+				}
+			}
+		}));
+	}
+	for (auto& worker : workers) {
+		worker.join();
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return (double)BENCH_REQUESTS_PER_CART * carts / seconds;
+}
+
+int main(int argc, char* argv[]) {
+
+	long carts = BENCH_CARTS;
+	int skus = BENCH_SKUS;
+	int nclients = 0;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--carts" && i + 1 < argc && std::atol(argv[i + 1]) > 0) {
+			carts = std::atol(argv[++i]);
+		}
+		else if (arg == "--skus" && i + 1 < argc && std::atoi(argv[i + 1]) > 0) {
+			skus = std::atoi(argv[++i]);
+		}
+		else if (arg == "--clients" && i + 1 < argc && std::atoi(argv[i + 1]) > 0) {
+			nclients = std::atoi(argv[++i]);
+		}
+	}
+
+	std::cout << carts << " carts of " << BENCH_CART_ITEMS << " items, " << skus << " SKUs, "
+		<< std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+	std::cout << "clients\tserver mutex req/s\tper-SKU locks req/s\tspeedup" << std::endl;
+
+	std::vector<int> counts = { 1, 2, 4, 8, 16, 32, 64 };
+	if (nclients > 0) {
+		counts.assign(1, nclients);
+	}
+	for (int n : counts) {
+		double serialized = run(skus, n, carts, true);
+		double striped = run(skus, n, carts, false);
+		std::cout << n << "\t" << (long)serialized << "\t" << (long)striped << "\t" << striped / serialized << std::endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,182 @@
+/**
+* Counts the heap allocations made for each order on its way through the warehouse
+* computer, the way the server, the robots and the truck monitor handle it: the
+* shopper's cart is held, the order is confirmed and queued for picking, a robot
+* picks it, it waits for a delivery truck, a robot loads it, and the shopper
+* checks on it.  Messages arrive in the binary encoding, so the count is not
+* swamped by the JSON parser.  Every allocation made by operator new or new[] is
+* counted, along with the bytes asked for.
+*
+* Usage: orderBenchmark [options]
+*   --orders <n>     orders passed through (default 10000)
+*   --items <n>      items in each order (default 3)
+*/
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "WarehouseObjects.h"
+#include "WarehouseInventory.h"
+#include "Message.h"
+#include "BinaryConverter.h"
+#include "SimClock.h"
+#include "PickupQueue.h"
+#include "RestockingQueue.h"
+#include "DeliveryTruckQueue.h"
+#include "DeliveryCompQueue.h"
+#include "RobotDispatcher.h"
+
+#define BENCH_ORDERS 10000
+#define BENCH_ORDER_ITEMS 3
+#define BENCH_CATALOG 100
+
+static std::atomic<long> allocations(0);
+static std::atomic<long> allocatedBytes(0);
+
+/**
+* Allocates memory for operator new and new[], counting the allocation
+*/
+static void* countedAlloc(std::size_t size) {
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	allocatedBytes.fetch_add((long)size, std::memory_order_relaxed);
+	void* p = std::malloc(size == 0 ? 1 : size);
+	if (p == nullptr) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+// every form of new and delete is replaced, so each allocation is counted and
+// freed by the allocator that made it
+void* operator new(std::size_t size) {
+	return countedAlloc(size);
+}
+
+void* operator new[](std::size_t size) {
+	return countedAlloc(size);
+}
+
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+	std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+	std::free(p);
+}
+
+int main(int argc, char* argv[]) {
+
+	long orders = BENCH_ORDERS;
+	int items = BENCH_ORDER_ITEMS;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--orders" && i + 1 < argc && std::atol(argv[i + 1]) > 0) {
+			orders = std::atol(argv[++i]);
+		}
+		else if (arg == "--items" && i + 1 < argc && std::atoi(argv[i + 1]) > 0) {
+			items = std::atoi(argv[++i]);
+		}
+	}
+
+	// a catalog with plenty of stock, names long enough not to fit in a short string
+	std::vector<ItemEntry> catalog;
+	for (int i = 0; i < BENCH_CATALOG; i++) {
+		catalog.push_back(ItemEntry("Catalog item number " + std::to_string(i), 1000000, 1000 + i, 1.5, 10));
+	}
+	WarehouseInventory lib(catalog);
+	OrderList orderList;
+	SimClock clock(CLOCK_VIRTUAL);
+	PickupQueue pick(clock);
+	RestockingQueue restock;
+	DeliveryTruckQueue delivertruck;
+	DeliveryCompQueue delivercomp;
+	RobotDispatcher dispatcher(pick, restock, delivertruck);
+
+	// what the shoppers send, encoded before counting starts
+	std::vector<std::string> batches, confirms;
+	for (long n = 0; n < orders; n++) {
+		std::vector<ItemEntry> cart;
+		for (int i = 0; i < items; i++) {
+			ItemEntry entry = catalog[(n * items + i) % BENCH_CATALOG];
+			entry.quantityAvailable = 1;
+			cart.push_back(entry);
+		}
+		std::string batch, confirm;
+		BinaryConverter::encode(BatchAddMessage(cart), batch);
+		BinaryConverter::encode(ConfirmOrder(cart, "express"), confirm);
+		batches.push_back(batch);
+		confirms.push_back(confirm);
+	}
+
+	long before = allocations.load();
+	long bytesBefore = allocatedBytes.load();
+	auto start = std::chrono::steady_clock::now();
+	long checked = 0;
+	for (long n = 0; n < orders; n++) {
+		// server: hold the cart
+		std::unique_ptr<Message> msg = BinaryConverter::decode(batches[n].data(), batches[n].size());
+		BatchAddMessage& batch = (BatchAddMessage&)*msg;
+		std::vector<std::pair<int, int>> holds;
+		holds.reserve(batch.items.size());
+		for (auto& item : batch.items) {
+			holds.push_back(std::make_pair(item.ID, item.quantityAvailable));
+		}
+		std::vector<ItemEntry> results;
+		results.reserve(batch.items.size());
+		if (lib.holdItems(holds)) {
+			for (auto& item : batch.items) {
+				lib.visit_id(item.ID, [&](const ItemEntry& entry) {
+					results.push_back(entry);
+				});
+			}
+		}
+		BatchAddResponseMessage held(std::move(results), MESSAGE_STATUS_OK);
+
+		// server: confirm the order and queue it for picking
+		msg = BinaryConverter::decode(confirms[n].data(), confirms[n].size());
+		ConfirmOrder& confirm = (ConfirmOrder&)*msg;
+		std::vector<Item> list = OrderEntry::entrytoitem(confirm.order);
+		int orderNum = orderList.addEntry(std::move(confirm.order));
+		Order order(std::move(list), orderNum);
+		order.setSlaClass(pick.slaClass(confirm.sla));
+		pick.addToPQueue(std::move(order));
+
+		// robot: pick it and hand it over for delivery
+		RobotJob job;
+		dispatcher.tryNext(job);
+		delivercomp.addToDCQueue(std::move(job.order));
+
+		// truck monitor: load it onto a delivery truck
+		Order picked = delivercomp.removeFromDCQueue();
+		orderList.changeStatus(picked.getOrderNum(), "LOADING");
+		delivertruck.addToDTQueue(tCommand(std::move(picked), 0));
+
+		// robot: take it to the truck
+		dispatcher.tryNext(job);
+
+		// shopper: check on it
+		orderList.visitOrder(job.order.getOrderNum(), [&](const OrderEntry& entry) {
+			checked += entry.status == "LOADING" ? 1 : 0;
+		});
+	}
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	long counted = allocations.load() - before;
+	long bytes = allocatedBytes.load() - bytesBefore;
+
+	std::cout << orders << " orders of " << items << " items, " << checked << " loaded" << std::endl;
+	std::cout << "allocations/order\tbytes/order\tus/order" << std::endl;
+	std::cout << (double)counted / orders << "\t" << (double)bytes / orders << "\t" << 1000.0 * ms / orders << std::endl;
+	return 0;
+}
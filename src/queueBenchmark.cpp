@@ -0,0 +1,106 @@
+/**
+* Measures how fast orders move through the robots' work queues: the lock-free
+* MpmcQueue they are built on, against a mutex-protected queue (BoundedQueue) for
+* comparison.  Equal numbers of producer and consumer threads pass orders of a
+* few items each through one queue, and the rate is counted in operations (adds
+* plus removes) per second.
+*
+* Usage: queueBenchmark [options]
+*   --orders <n>     orders passed through the queue in each run (default 200000)
+*   --capacity <n>   queue capacity (default 1024)
+*   --threads <n>    producers and consumers each (default: compare 1 up to 64)
+*/
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "WarehouseObjects.h"
+#include "BoundedQueue.h"
+#include "MpmcQueue.h"
+
+#define BENCH_ORDERS 200000
+#define BENCH_CAPACITY 1024
+#define BENCH_ORDER_ITEMS 3
+
+/**
+* Passes orders from producers to consumers through a queue
+* @param queue queue to pass the orders through
+* @param threads producers, and consumers
+* @param orders orders to pass through altogether
+* @return operations per second
+*/
+template<typename Queue>
+double run(Queue& queue, int threads, long orders) {
+	std::vector<Item> items;
+	for (int i = 0; i < BENCH_ORDER_ITEMS; i++) {
+		items.push_back(Item("Item " + std::to_string(i), i, 1, 1.0));
+	}
+
+	std::atomic<long> consumed(0);
+	std::vector<std::thread> workers;
+	auto start = std::chrono::steady_clock::now();
+	for (int t = 0; t < threads; t++) {
+		long share = orders / threads + (t < orders % threads ? 1 : 0);
+		workers.push_back(std::thread([&queue, &items, share, t]() {
+			for (long i = 0; i < share; i++) {
+				queue.push(Order(items, t));
+			}
+		}));
+		workers.push_back(std::thread([&queue, &consumed, orders]() {
+			Order order;
+			while (queue.pop(order)) {
+				// the last order through closes the queue, waking the other consumers
+				if (++consumed == orders) {
+					queue.close();
+				}
+			}
+		}));
+	}
+	for (auto& worker : workers) {
+		worker.join();
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return 2.0 * orders / seconds;
+}
+
+int main(int argc, char* argv[]) {
+
+	long orders = BENCH_ORDERS;
+	size_t capacity = BENCH_CAPACITY;
+	int nthreads = 0;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--orders" && i + 1 < argc && std::atol(argv[i + 1]) > 0) {
+			orders = std::atol(argv[++i]);
+		}
+		else if (arg == "--capacity" && i + 1 < argc && std::atol(argv[i + 1]) > 0) {
+			capacity = std::atol(argv[++i]);
+		}
+		else if (arg == "--threads" && i + 1 < argc && std::atoi(argv[i + 1]) > 0) {
+			nthreads = std::atoi(argv[++i]);
+		}
+	}
+
+	std::cout << orders << " orders of " << BENCH_ORDER_ITEMS << " items, capacity " << capacity << ", "
+		<< std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+	std::cout << "producers\tconsumers\tmutex ops/s\tlock-free ops/s\tspeedup" << std::endl;
+
+	std::vector<int> counts = { 1, 2, 4, 8, 16, 32, 64 };
+	if (nthreads > 0) {
+		counts.assign(1, nthreads);
+	}
+	for (int n : counts) {
+		BoundedQueue<Order> locked(capacity);
+		MpmcQueue<Order> lockFree(capacity);
+		double lockedRate = run(locked, n, orders);
+		double lockFreeRate = run(lockFree, n, orders);
+		std::cout << n << "\t" << n << "\t" << (long)lockedRate << "\t" << (long)lockFreeRate << "\t"
+			<< lockFreeRate / lockedRate << std::endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,264 @@
+/**
+* Measures how framed messages are read from a socket: the buffered frame reader
+* JsonUserClientApi uses now (FrameBuffer, filled by large reads), against the way
+* it used to read them (the type byte and payload size read on their own, then
+* the payload in 256-byte read_all calls appended to a string).  JSON search
+* responses of a few sizes are sent over a loopback TCP connection, and every
+* read call is counted.
+*
+* Two rates are measured for each size: streamed, where the sender writes frames
+* as fast as it can and the reader keeps up, and round trip, where the reader
+* asks for one frame at a time and waits for it, as a shopper waits for a reply.
+*
+* Linux only, since it reads the sockets directly to count the calls.
+*
+* Usage: readBenchmark [options]
+*   --messages <n>   frames read per run (default 20000)
+*   --results <n>    entries in each search response (default: compare 0 up to 1000)
+*/
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+
+#include "WarehouseInventory.h"
+#include "Message.h"
+#include "FrameBuffer.h"
+#include "JsonUserClientApi.h"
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#define BENCH_MESSAGES 20000
+#define LEGACY_READ_SIZE 256   // bytes per read_all call in the old reader
+
+static long reads = 0;
+
+/**
+* Reads from a socket, counting the call
+*/
+static ssize_t countedRead(int fd, void* buff, size_t size) {
+	reads++;
+	return ::read(fd, buff, size);
+}
+
+/**
+* Reads exactly a number of bytes, as cpen333's socket::read_all does
+*/
+static bool readAll(int fd, void* buff, size_t size) {
+	char* cbuff = (char*)buff;
+	size_t nread = 0;
+	while (nread < size) {
+		ssize_t n = countedRead(fd, cbuff + nread, size - nread);
+		if (n <= 0) {
+			return false;
+		}
+		nread += n;
+	}
+	return true;
+}
+
+/**
+* The old reader: header fields read one at a time, payload in 256-byte pieces
+*/
+class LegacyReader {
+	int fd_;
+
+public:
+	LegacyReader(int fd) : fd_(fd) {}
+
+	bool next(std::string& payload) {
+		char id;
+		unsigned char buff[4];
+		if (!readAll(fd_, &id, 1) || !readAll(fd_, buff, 4)) {
+			return false;
+		}
+		size_t size = ((size_t)buff[0] << 24) | ((size_t)buff[1] << 16) | ((size_t)buff[2] << 8) | buff[3];
+
+		std::string str;
+		char cbuff[LEGACY_READ_SIZE];
+		size_t nwritten = 0;
+		while (nwritten < size) {
+			size_t blocksize = std::min<size_t>(size - nwritten, LEGACY_READ_SIZE);
+			if (!readAll(fd_, cbuff, blocksize)) {
+				return false;
+			}
+			str.append(cbuff, blocksize);
+			nwritten += blocksize;
+		}
+		payload.swap(str);
+		return true;
+	}
+};
+
+/**
+* The buffered reader, as in JsonUserClientApi::recvMessage
+*/
+class BufferedReader {
+	int fd_;
+	FrameBuffer input_;
+
+public:
+	BufferedReader(int fd) : fd_(fd), input_() {}
+
+	bool next(std::string& payload) {
+		char id;
+		FrameStatus status;
+		while ((status = input_.next(id, payload)) == FRAME_INCOMPLETE) {
+			ssize_t nread = countedRead(fd_, input_.prepare(API_READ_SIZE), API_READ_SIZE);
+			if (nread <= 0) {
+				return false;
+			}
+			input_.commit(nread);
+		}
+		return status == FRAME_READY;
+	}
+};
+
+/**
+* Opens a loopback TCP connection
+* @param reader populated with the reading end
+* @param writer populated with the writing end
+* @return true if connected
+*/
+bool connectPair(int& reader, int& writer) {
+	int listener = socket(AF_INET, SOCK_STREAM, 0);
+	sockaddr_in addr = {};
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = 0;
+	socklen_t len = sizeof(addr);
+	if (listener < 0 || bind(listener, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(listener, 1) != 0 ||
+		getsockname(listener, (sockaddr*)&addr, &len) != 0) {
+		return false;
+	}
+	writer = socket(AF_INET, SOCK_STREAM, 0);
+	if (writer < 0 || connect(writer, (sockaddr*)&addr, sizeof(addr)) != 0) {
+		return false;
+	}
+	reader = accept(listener, nullptr, nullptr);
+	::close(listener);
+	int one = 1;
+	setsockopt(writer, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+	setsockopt(reader, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+	return reader >= 0;
+}
+
+/**
+* Writes a whole buffer to a socket
+*/
+static bool writeAll(int fd, const char* data, size_t size) {
+	while (size > 0) {
+		ssize_t n = ::write(fd, data, size);
+		if (n <= 0) {
+			return false;
+		}
+		data += n;
+		size -= n;
+	}
+	return true;
+}
+
+/**
+* Reads frames with a reader
+* @param frame frame to send
+* @param messages frames to read
+* @param roundTrip ask for each frame and wait for it, rather than streaming them
+* @param readsPerMessage populated with the read calls per frame
+* @return microseconds per frame
+*/
+template<typename Reader>
+double run(const std::string& frame, long messages, bool roundTrip, double& readsPerMessage) {
+	int reader, writer;
+	if (!connectPair(reader, writer)) {
+		std::cout << "Unable to open a loopback connection" << std::endl;
+		std::exit(1);
+	}
+
+	std::thread sender([&frame, messages, roundTrip, writer]() {
+		char ask;
+		for (long i = 0; i < messages; i++) {
+			if (roundTrip && ::read(writer, &ask, 1) != 1) {
+				break;
+			}
+			if (!writeAll(writer, frame.data(), frame.size())) {
+				break;
+			}
+		}
+	});
+
+	Reader in(reader);
+	std::string payload;
+	reads = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (long i = 0; i < messages; i++) {
+		char ask = 0;
+		if ((roundTrip && !writeAll(reader, &ask, 1)) || !in.next(payload) || payload.size() + FRAME_HEADER_SIZE != frame.size()) {
+			std::cout << "Frame " << i << " was not read" << std::endl;
+			std::exit(1);
+		}
+	}
+	double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / messages;
+	readsPerMessage = (double)reads / messages;
+
+	sender.join();
+	::close(reader);
+	::close(writer);
+	return us;
+}
+
+int main(int argc, char* argv[]) {
+
+	long messages = BENCH_MESSAGES;
+	int nresults = -1;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--messages" && i + 1 < argc && std::atol(argv[i + 1]) > 0) {
+			messages = std::atol(argv[++i]);
+		}
+		else if (arg == "--results" && i + 1 < argc && std::atoi(argv[i + 1]) >= 0) {
+			nresults = std::atoi(argv[++i]);
+		}
+	}
+
+	std::cout << messages << " JSON search responses per run" << std::endl;
+	std::cout << "results\tframe bytes\tmode\told reads/msg\tbuffered reads/msg\told us/msg\tbuffered us/msg" << std::endl;
+
+	std::vector<int> counts = { 0, 10, 100, 1000 };
+	if (nresults >= 0) {
+		counts.assign(1, nresults);
+	}
+	for (int n : counts) {
+		std::vector<ItemEntry> results;
+		for (int i = 0; i < n; i++) {
+			results.push_back(ItemEntry("Catalog item number " + std::to_string(i), 10 + i, 1000 + i, 1.5, 25));
+		}
+		std::string frame = JsonUserClientApi::encodeFrame(SearchResponseMessage(std::move(results), MESSAGE_STATUS_OK));
+
+		for (bool roundTrip : { false, true }) {
+			double legacyReads, bufferedReads;
+			double legacyUs = run<LegacyReader>(frame, messages, roundTrip, legacyReads);
+			double bufferedUs = run<BufferedReader>(frame, messages, roundTrip, bufferedReads);
+			std::cout << n << "\t" << frame.size() << "\t" << (roundTrip ? "round trip" : "streamed") << "\t"
+				<< legacyReads << "\t" << bufferedReads << "\t" << legacyUs << "\t" << bufferedUs << std::endl;
+		}
+	}
+
+	return 0;
+}
+
+#else
+
+int main() {
+	std::cout << "The read benchmark is only available on Linux" << std::endl;
+	return 0;
+}
+
+#endif
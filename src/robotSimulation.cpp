@@ -0,0 +1,716 @@
+/**
+* Simulates a day in the warehouse in virtual time: orders arriving, robots picking
+* them, trucks docking to be loaded or unloaded.  This is a discrete-event
+* simulation, time jumps straight from one event to the next, so it runs as fast
+* as the CPU allows instead of one robot step per 100 ms.
+*
+* Robots are handed jobs by the same RobotDispatcher and plan their trips in the
+* same ReservationTable as the warehouse robots, and take one tick per cell just
+* like robots following their reserved routes in real time, so a simulated day
+* plays out as it would in real time.  Every run checks that no two robots ever
+* shared an aisle cell or swapped cells.
+*
+* Usage: robotSimulation [maze file] [options]
+*   --ticks <n>        length of the simulated day (default 5000)
+*   --shelves <n>      shelves each order is picked from (default 3)
+*   --robots <n>       simulate this many robots (default: compare 1 up to MAX_ROBOTS)
+*   --arrivals <n>     orders arriving per 1000 ticks (default: a new order whenever
+*                      one is picked, keeping every robot busy)
+*   --trucks <n>       ticks between trucks, alternating delivery and restocking
+*                      (default 0, no trucks)
+*   --order-weight <w> weight of the items in each order (default 20)
+*   --no-waves         pick one order per trip instead of batching orders into waves
+*   --no-assign        pick the oldest order first instead of the one the assignment
+*                      engine chooses
+*   --express <pct>    percentage of orders in the express service class (default 20)
+*   --economy <pct>    percentage of orders in the economy service class (default 20),
+*                      the rest are standard
+*   --fifo             hand out orders oldest first instead of due soonest first
+*/
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <queue>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "WarehouseCommon.h"
+#include "PathPlanner.h"
+#include "RouteOptimizer.h"
+#include "ReservationTable.h"
+#include "RobotDispatcher.h"
+#include "SimClock.h"
+#include "WavePlanner.h"
+#include "AssignmentEngine.h"
+#include "SlaQueue.h"
+#include "LatencyStats.h"
+
+#define SIM_TICKS 5000
+#define SIM_ORDER_SHELVES 3
+#define SIM_ORDER_WEIGHT 20
+#define SIM_EXPRESS_PCT 20
+#define SIM_ECONOMY_PCT 20
+
+/**
+* Things that happen in the simulation
+*/
+enum SimEventType {
+	EVENT_ORDER_ARRIVAL,   // a customer order comes in
+	EVENT_TRUCK_ARRIVAL,   // a truck pulls in
+	EVENT_ROBOT_READY,     // a robot looks for work, or tries again to reserve its trip
+	EVENT_TRIP_DONE        // a robot is back from a trip
+};
+
+struct SimEvent {
+	long tick;
+	long seq;      // keeps events at the same tick in the order they were scheduled
+	SimEventType type;
+	int id;        // robot, where it applies
+
+	friend bool operator>(const SimEvent& a, const SimEvent& b) {
+		return a.tick != b.tick ? a.tick > b.tick : a.seq > b.seq;
+	}
+};
+
+/**
+* A simulated robot
+*/
+struct SimRobot {
+	bool idle;                      // waiting for work
+	bool hasJob;
+	RobotJob job;
+	std::vector<Order> wave;        // orders picked on this trip
+	long ready;                     // tick it started trying to reserve its trip
+	long departed;                  // tick its trip started
+	std::vector<Coordinates> route;
+	std::vector<size_t> arrivals;
+	std::vector<std::pair<long, std::vector<Coordinates>>> trips;  // every trip, to check for collisions
+};
+
+/**
+* A dock
+*/
+struct SimDock {
+	bool occupied;
+	bool delivery;         // the truck docked is a delivery truck
+	bool waitingForOrder;  // delivery truck docked with no picked order to load yet
+};
+
+/**
+* Results of a simulated day
+*/
+struct SimResults {
+	long arrived;
+	long picked;
+	long delivered;
+	long restocked;
+	long trips;
+	long tripTicks;
+	long pickTicks;        // ticks spent on picking trips
+	long waitTicks;        // ticks spent at the depot waiting to reserve a trip
+	long latencyTicks;     // ticks from order arrival to picked
+	long latencyMax;
+	long collisions;
+	double wallMs;
+	std::vector<SlaReport> classes;   // latency of each service class
+};
+
+class WarehouseSim {
+	const PathPlanner& planner_;
+	const WarehouseInfo& winfo_;
+	const std::vector<Coordinates>& shelves_;
+	Coordinates start_;
+	Coordinates exit_;
+	int orderShelves_;
+	long arrivalGap_;      // mean ticks between orders, 0 to keep the robots saturated
+	long truckGap_;
+	double orderWeight_;
+	bool waves_;
+	std::vector<SlaClass> classes_;   // service classes, with the targets orders are measured against
+	double expressShare_;
+	double economyShare_;
+
+	SimClock clock_;
+	RouteOptimizer optimizer_;
+	WavePlanner wavePlanner_;
+	AssignmentEngine engine_;
+	ReservationTable reservations_;
+	PickupQueue pickup_;
+	RestockingQueue restock_;
+	DeliveryTruckQueue delivery_;
+	RobotDispatcher dispatcher_;
+
+	std::vector<SimRobot> robots_;
+	std::vector<SimDock> docks_;
+	std::deque<bool> trucksWaiting_;   // trucks with no free dock, true for delivery
+	bool nextTruckDelivery_;
+	std::deque<Order> completed_;      // picked orders waiting for a delivery truck
+	std::map<int, std::vector<Coordinates>> orderStops_;
+	std::map<int, long> orderArrived_;
+	std::vector<LatencyStats> classLatency_;
+	std::vector<long> classMissed_;
+	int nextOrder_;
+
+	std::priority_queue<SimEvent, std::vector<SimEvent>, std::greater<SimEvent>> events_;
+	long seq_;
+	std::default_random_engine rnd_;
+	SimResults results_;
+
+	void schedule(long tick, SimEventType type, int id = -1) {
+		SimEvent event = { tick, seq_++, type, id };
+		events_.push(event);
+	}
+
+	/**
+	* Schedules every idle robot to look for work
+	*/
+	void wakeIdle() {
+		for (size_t i = 0; i < robots_.size(); i++) {
+			if (robots_[i].idle) {
+				robots_[i].idle = false;
+				schedule(clock_.now(), EVENT_ROBOT_READY, (int)i);
+			}
+		}
+	}
+
+	void addOrder() {
+		std::uniform_int_distribution<size_t> shelfdist(0, shelves_.size() - 1);
+		int num = nextOrder_++;
+		std::vector<Coordinates> stops;
+		for (int i = 0; i < orderShelves_; i++) {
+			stops.push_back(shelves_[shelfdist(rnd_)]);
+		}
+		orderStops_[num] = stops;
+		orderArrived_[num] = clock_.now();
+		Order order(num);
+		double share = std::uniform_real_distribution<double>(0, 1)(rnd_);
+		order.setSlaClass(share < expressShare_ ? 0 : share < expressShare_ + economyShare_ ? 2 : 1);
+		pickup_.addToPQueue(order);
+		results_.arrived++;
+		wakeIdle();
+	}
+
+	Coordinates dockLocation(int dock) const {
+		return Coordinates(winfo_.docks.dloc[dock][ROW_IDX], winfo_.docks.dloc[dock][COL_IDX]);
+	}
+
+	/**
+	* Docks a truck, giving the robots its job like the warehouse computer does
+	*/
+	void dockTruck(int dock, bool delivery) {
+		SimDock& d = docks_[dock];
+		d.occupied = true;
+		d.delivery = delivery;
+		d.waitingForOrder = false;
+		if (!delivery) {
+			restock_.addToTQueue(trCommand(dock));
+		}
+		else if (!completed_.empty()) {
+			delivery_.addToDTQueue(tCommand(std::move(completed_.front()), dock));
+			completed_.pop_front();
+		}
+		else {
+			d.waitingForOrder = true;
+		}
+		wakeIdle();
+	}
+
+	void undockTruck(int dock) {
+		docks_[dock].occupied = false;
+		if (!trucksWaiting_.empty()) {
+			bool delivery = trucksWaiting_.front();
+			trucksWaiting_.pop_front();
+			dockTruck(dock, delivery);
+		}
+	}
+
+	void onTruckArrival() {
+		bool delivery = nextTruckDelivery_;
+		nextTruckDelivery_ = !nextTruckDelivery_;
+		schedule(clock_.now() + truckGap_, EVENT_TRUCK_ARRIVAL);
+
+		for (size_t i = 0; i < docks_.size(); i++) {
+			if (!docks_[i].occupied) {
+				dockTruck((int)i, delivery);
+				return;
+			}
+		}
+		trucksWaiting_.push_back(delivery);
+	}
+
+	void onOrderArrival() {
+		addOrder();
+		if (arrivalGap_ > 0) {
+			std::exponential_distribution<double> gap(1.0 / arrivalGap_);
+			schedule(clock_.now() + 1 + (long)gap(rnd_), EVENT_ORDER_ARRIVAL);
+		}
+	}
+
+	void onRobotReady(int id) {
+		SimRobot& robot = robots_[id];
+		long now = clock_.now();
+
+		if (!robot.hasJob) {
+			if (!dispatcher_.tryNext(robot.job)) {
+				robot.idle = true;
+				return;
+			}
+			robot.hasJob = true;
+			robot.ready = now;
+			robot.wave.assign(1, robot.job.order);
+			if (robot.job.type == JOB_PICKUP) {
+				gatherWave(robot);
+			}
+		}
+
+		std::vector<Coordinates> stops;
+		Coordinates finish = start_;
+		if (robot.job.type == JOB_PICKUP) {
+			std::vector<Coordinates> shelves;
+			for (auto& order : robot.wave) {
+				for (auto& shelf : orderStops_[order.getOrderNum()]) {
+					bool listed = false;
+					for (auto& s : shelves) {
+						listed = listed || (s.XCoordinates == shelf.XCoordinates && s.YCoordinates == shelf.YCoordinates);
+					}
+					if (!listed) {
+						shelves.push_back(shelf);
+					}
+				}
+			}
+			for (size_t i : optimizer_.plan(start_, shelves, exit_)) {
+				stops.push_back(shelves[i]);
+			}
+			finish = exit_;
+		}
+		else {
+			stops.push_back(dockLocation(robot.job.dockNumber));
+		}
+
+		if (!reservations_.reserve(id + 1, start_, now, stops, finish, robot.route, robot.arrivals)) {
+			// wait at the depot and try again next tick
+			schedule(now + 1, EVENT_ROBOT_READY, id);
+			return;
+		}
+		robot.departed = now;
+		robot.trips.push_back(std::make_pair(now, robot.route));
+		results_.trips++;
+		results_.tripTicks += robot.route.size();
+		if (robot.job.type == JOB_PICKUP) {
+			results_.pickTicks += robot.route.size();
+		}
+		results_.waitTicks += now - robot.ready;
+		schedule(now + (long)robot.route.size(), EVENT_TRIP_DONE, id);
+	}
+
+	void onTripDone(int id) {
+		SimRobot& robot = robots_[id];
+		reservations_.release(id + 1);
+		robot.hasJob = false;
+
+		if (robot.job.type == JOB_PICKUP) {
+			for (auto& order : robot.wave) {
+				int num = order.getOrderNum();
+				results_.picked++;
+				long latency = clock_.now() - orderArrived_[num];
+				results_.latencyTicks += latency;
+				results_.latencyMax = std::max(results_.latencyMax, latency);
+				int sla = order.getSlaClass();
+				classLatency_[sla].record(latency);
+				if (latency > classes_[sla].target) {
+					classMissed_[sla]++;
+				}
+				orderStops_.erase(num);
+				orderArrived_.erase(num);
+				completed_.push_back(order);
+				if (arrivalGap_ == 0) {
+					addOrder();
+				}
+			}
+
+			// a delivery truck may be waiting for them, otherwise they wait for one
+			for (size_t i = 0; i < docks_.size() && !completed_.empty(); i++) {
+				if (docks_[i].occupied && docks_[i].waitingForOrder) {
+					docks_[i].waitingForOrder = false;
+					delivery_.addToDTQueue(tCommand(std::move(completed_.front()), (int)i));
+					completed_.pop_front();
+				}
+			}
+			if (truckGap_ == 0) {
+				completed_.clear();
+			}
+		}
+		else if (robot.job.type == JOB_DELIVERY) {
+			results_.delivered++;
+			undockTruck(robot.job.dockNumber);
+		}
+		else {
+			results_.restocked++;
+			undockTruck(robot.job.dockNumber);
+		}
+
+		// back at the start, like Robot::main after each job
+		onRobotReady(id);
+	}
+
+	/**
+	* @return robots with no job, idle or about to look for one
+	*/
+	size_t idleRobots() const {
+		size_t idle = 0;
+		for (auto& robot : robots_) {
+			if (!robot.hasJob) {
+				idle++;
+			}
+		}
+		return idle;
+	}
+
+	/**
+	* Chooses the orders a robot picks on its trip, like Robot::gatherWave: the
+	* waiting order the assignment engine gives it, and the orders worth picking
+	* with it in a wave
+	* @param robot robot with a pickup job
+	*/
+	void gatherWave(SimRobot& robot) {
+		if (!waves_ && dispatcher_.engine() == nullptr) {
+			return;
+		}
+		std::vector<Order> orders(1, robot.job.order);
+		std::vector<Order> pending = dispatcher_.takePickups(WAVE_CANDIDATES);
+		if (pending.empty()) {
+			return;
+		}
+		orders.insert(orders.end(), pending.begin(), pending.end());
+
+		std::vector<WaveOrder> waiting;
+		for (auto& order : orders) {
+			WaveOrder w = { orderStops_[order.getOrderNum()], orderWeight_, order.getDeadline() - clock_.now() };
+			waiting.push_back(w);
+		}
+
+		// the order this robot can complete soonest, counting how soon each is due
+		size_t seed = 0;
+		if (dispatcher_.engine() != nullptr) {
+			RobotState state = { start_, MAX_ROBOT_CAPACITY };
+			seed = (size_t)engine_.match(std::vector<RobotState>(1, state), waiting)[0];
+		}
+		robot.job.order = orders[seed];
+		robot.wave.assign(1, orders[seed]);
+
+		std::vector<size_t> rest;
+		std::vector<WaveOrder> others;
+		for (size_t i = 0; i < orders.size(); i++) {
+			if (i != seed) {
+				rest.push_back(i);
+				others.push_back(waiting[i]);
+			}
+		}
+		std::vector<bool> joined(rest.size(), false);
+		if (waves_) {
+			for (size_t i : wavePlanner_.plan(waiting[seed], others, idleRobots())) {
+				joined[i] = true;
+				robot.wave.push_back(orders[rest[i]]);
+			}
+		}
+		std::vector<Order> back;
+		for (size_t i = 0; i < rest.size(); i++) {
+			if (!joined[i]) {
+				back.push_back(orders[rest[i]]);
+			}
+		}
+		dispatcher_.returnPickups(back);
+	}
+
+	/**
+	* Service classes the pickup queue orders by: the real ones, or ones all due as
+	* late as the least urgent class, which hands out the oldest order first
+	*/
+	static std::vector<SlaClass> queueClasses(const std::vector<SlaClass>& classes, bool fifo) {
+		std::vector<SlaClass> queued = classes;
+		for (auto& sla : queued) {
+			sla.target = fifo ? classes.back().target : sla.target;
+		}
+		return queued;
+	}
+
+	/**
+	* Replays every trip tick by tick, counting robots sharing an aisle cell or
+	* swapping cells.  Robots are at the start when not on a trip.
+	*/
+	long countCollisions(long ticks) const {
+		int cols = planner_.cols();
+		int depotStart = start_.XCoordinates * cols + start_.YCoordinates;
+		int depotExit = exit_.XCoordinates * cols + exit_.YCoordinates;
+		std::vector<std::vector<int>> at(robots_.size(), std::vector<int>(ticks + 1, depotStart));
+		for (size_t r = 0; r < robots_.size(); r++) {
+			for (const auto& trip : robots_[r].trips) {
+				for (size_t i = 0; i < trip.second.size() && trip.first + 1 + (long)i <= ticks; i++) {
+					const Coordinates& c = trip.second[i];
+					at[r][trip.first + 1 + i] = c.XCoordinates * cols + c.YCoordinates;
+				}
+			}
+		}
+
+		long collisions = 0;
+		for (long t = 0; t <= ticks; t++) {
+			std::set<int> occupied;
+			for (size_t a = 0; a < robots_.size(); a++) {
+				int cell = at[a][t];
+				if (cell != depotStart && cell != depotExit && !occupied.insert(cell).second) {
+					collisions++;
+				}
+				for (size_t b = a + 1; t > 0 && b < robots_.size(); b++) {
+					if (at[a][t] != at[b][t] && at[a][t] == at[b][t - 1] && at[b][t] == at[a][t - 1]) {
+						collisions++;
+					}
+				}
+			}
+		}
+		return collisions;
+	}
+
+public:
+	WarehouseSim(const PathPlanner& planner, const WarehouseInfo& winfo, const RobotInfo& rinfo,
+		const std::vector<Coordinates>& shelves, int nrobots, int orderShelves, long arrivalGap, long truckGap,
+		double orderWeight, bool waves, bool assign, double expressShare, double economyShare, bool fifo) :
+		planner_(planner), winfo_(winfo), shelves_(shelves),
+		start_(rinfo.startx, rinfo.starty), exit_(rinfo.endx, rinfo.endy),
+		orderShelves_(orderShelves), arrivalGap_(arrivalGap), truckGap_(truckGap),
+		orderWeight_(orderWeight), waves_(waves), classes_(defaultSlaClasses()),
+		expressShare_(expressShare), economyShare_(economyShare),
+		clock_(CLOCK_VIRTUAL), optimizer_(planner), wavePlanner_(planner, rinfo), engine_(planner, rinfo), reservations_(planner, rinfo, clock_),
+		pickup_(clock_, queueClasses(classes_, fifo)), restock_(), delivery_(), dispatcher_(pickup_, restock_, delivery_),
+		robots_(nrobots), docks_(winfo.docks.ndocks), trucksWaiting_(), nextTruckDelivery_(true),
+		completed_(), orderStops_(), orderArrived_(), classLatency_(classes_.size()), classMissed_(classes_.size(), 0),
+		nextOrder_(1), events_(), seq_(0), rnd_(333), results_() {
+
+		for (auto& robot : robots_) {
+			robot.idle = true;
+			robot.hasJob = false;
+		}
+		for (auto& dock : docks_) {
+			dock.occupied = false;
+			dock.waitingForOrder = false;
+		}
+		if (assign) {
+			dispatcher_.attach(engine_);
+		}
+	}
+
+	/**
+	* Runs the simulated day
+	* @param ticks length of the day
+	* @return what happened
+	*/
+	SimResults run(long ticks) {
+		auto wallStart = std::chrono::steady_clock::now();
+
+		if (arrivalGap_ > 0) {
+			schedule(0, EVENT_ORDER_ARRIVAL);
+		}
+		else {
+			for (size_t i = 0; i < robots_.size(); i++) {
+				addOrder();
+			}
+		}
+		if (truckGap_ > 0 && !docks_.empty()) {
+			schedule(0, EVENT_TRUCK_ARRIVAL);
+		}
+
+		while (!events_.empty() && events_.top().tick <= ticks) {
+			SimEvent event = events_.top();
+			events_.pop();
+			clock_.advanceTo(event.tick);
+
+			switch (event.type) {
+			case EVENT_ORDER_ARRIVAL:
+				onOrderArrival();
+				break;
+			case EVENT_TRUCK_ARRIVAL:
+				onTruckArrival();
+				break;
+			case EVENT_ROBOT_READY:
+				onRobotReady(event.id);
+				break;
+			case EVENT_TRIP_DONE:
+				onTripDone(event.id);
+				break;
+			}
+		}
+
+		results_.collisions = countCollisions(ticks);
+		for (size_t i = 0; i < classes_.size(); i++) {
+			results_.classes.push_back(SlaReport{ classes_[i], classLatency_[i].summary(), classMissed_[i] });
+		}
+		results_.wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wallStart).count();
+		return results_;
+	}
+};
+
+/**
+* Reads maze from a filename and populates the maze, docks and robot start and exit
+* @param filename file to load maze from
+* @param winfo warehouse info to populate
+* @param rinfo robot info to populate
+* @return true if the maze was read
+*/
+bool load_layout(const std::string& filename, WarehouseInfo &winfo, RobotInfo &rinfo) {
+
+	winfo.rows = 0;
+	winfo.cols = 0;
+	winfo.docks.ndocks = 0;
+
+	std::ifstream fin(filename);
+	if (!fin.is_open()) {
+		return false;
+	}
+
+	std::string line;
+	int row = 0;
+	while (std::getline(fin, line) && row < MAX_WAREHOUSE_SIZE) {
+		int cols = std::min((int)line.length(), MAX_WAREHOUSE_SIZE);
+		if (cols > 0) {
+			if (cols > winfo.cols) {
+				winfo.cols = cols;
+			}
+			for (int col = 0; col < cols; ++col) {
+				winfo.maze[col][row] = line[col];
+				if (line[col] == START_CHAR) {
+					rinfo.startx = row;
+					rinfo.starty = col;
+				}
+				else if (line[col] == EXIT_CHAR) {
+					rinfo.endx = row;
+					rinfo.endy = col;
+				}
+				else if (line[col] == DOCK_CHAR && winfo.docks.ndocks < MAX_DOCK_CAPACITY) {
+					winfo.docks.dloc[winfo.docks.ndocks][COL_IDX] = col;
+					winfo.docks.dloc[winfo.docks.ndocks][ROW_IDX] = row;
+					winfo.docks.ndocks++;
+				}
+			}
+			++row;
+		}
+	}
+	winfo.rows = row;
+	return true;
+}
+
+int main(int argc, char* argv[]) {
+
+	std::string maze = "./data/maze3.txt";
+	long ticks = SIM_TICKS;
+	int orderShelves = SIM_ORDER_SHELVES;
+	int nrobots = 0;
+	long arrivalGap = 0;
+	long truckGap = 0;
+	double orderWeight = SIM_ORDER_WEIGHT;
+	bool waves = true;
+	bool assign = true;
+	double expressPct = SIM_EXPRESS_PCT;
+	double economyPct = SIM_ECONOMY_PCT;
+	bool fifo = false;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--ticks" && i + 1 < argc && std::atol(argv[i + 1]) > 0) {
+			ticks = std::atol(argv[++i]);
+		}
+		else if (arg == "--shelves" && i + 1 < argc && std::atoi(argv[i + 1]) > 0) {
+			orderShelves = std::atoi(argv[++i]);
+		}
+		else if (arg == "--robots" && i + 1 < argc && std::atoi(argv[i + 1]) > 0) {
+			nrobots = std::min(std::atoi(argv[++i]), MAX_ROBOTS);
+		}
+		else if (arg == "--arrivals" && i + 1 < argc && std::atof(argv[i + 1]) > 0) {
+			arrivalGap = std::max(1L, (long)(1000.0 / std::atof(argv[++i])));
+		}
+		else if (arg == "--trucks" && i + 1 < argc && std::atol(argv[i + 1]) > 0) {
+			truckGap = std::atol(argv[++i]);
+		}
+		else if (arg == "--order-weight" && i + 1 < argc && std::atof(argv[i + 1]) > 0) {
+			orderWeight = std::atof(argv[++i]);
+		}
+		else if (arg == "--no-waves") {
+			waves = false;
+		}
+		else if (arg == "--no-assign") {
+			assign = false;
+		}
+		else if (arg == "--express" && i + 1 < argc && std::atof(argv[i + 1]) >= 0) {
+			expressPct = std::atof(argv[++i]);
+		}
+		else if (arg == "--economy" && i + 1 < argc && std::atof(argv[i + 1]) >= 0) {
+			economyPct = std::atof(argv[++i]);
+		}
+		else if (arg == "--fifo") {
+			fifo = true;
+		}
+		else {
+			maze = arg;
+		}
+	}
+
+	static WarehouseInfo winfo;
+	static RobotInfo rinfo;
+	if (!load_layout(maze, winfo, rinfo)) {
+		std::cerr << "Failed to open file: " << maze << std::endl;
+		return 1;
+	}
+
+	PathPlanner planner(winfo, rinfo);
+	Coordinates start(rinfo.startx, rinfo.starty);
+	std::vector<Coordinates> shelves;
+	for (int r = 0; r < winfo.rows; r++) {
+		for (int c = 0; c < winfo.cols; c++) {
+			if (winfo.maze[c][r] == SHELF_CHAR && planner.distance(start, Coordinates(r, c)) != PATH_UNREACHABLE) {
+				shelves.push_back(Coordinates(r, c));
+			}
+		}
+	}
+	if (shelves.empty()) {
+		std::cerr << "No reachable shelves in " << maze << std::endl;
+		return 1;
+	}
+
+	std::cout << maze << ": " << shelves.size() << " shelves, " << winfo.docks.ndocks << " docks, "
+		<< orderShelves << " shelves per order, " << ticks << " ticks, "
+		<< (waves ? "waves" : "one order per trip") << ", "
+		<< (assign ? "assigned by cost" : "oldest order first") << ", "
+		<< expressPct << "% express, " << economyPct << "% economy, "
+		<< (fifo ? "oldest order first" : "due soonest first") << std::endl;
+	std::cout << "robots\tarrived\tpicked\tdelivered\trestocked\torders/1000 ticks\tsteps/order\tticks/trip\twait/trip\tlatency\tmax latency\tcollisions\twall ms" << std::endl;
+
+	std::vector<int> counts = { 1, 2, 4, 8, 12, 16, 24, 32, MAX_ROBOTS };
+	if (nrobots > 0) {
+		counts.assign(1, nrobots);
+	}
+	for (int n : counts) {
+		WarehouseSim sim(planner, winfo, rinfo, shelves, n, orderShelves, arrivalGap, truckGap, orderWeight, waves, assign,
+			expressPct / 100, economyPct / 100, fifo);
+		SimResults r = sim.run(ticks);
+		std::cout << n << "\t" << r.arrived << "\t" << r.picked << "\t" << r.delivered << "\t" << r.restocked << "\t"
+			<< (1000.0 * r.picked / ticks) << "\t"
+			<< (r.picked > 0 ? (double)r.pickTicks / r.picked : 0) << "\t"
+			<< (r.trips > 0 ? (double)r.tripTicks / r.trips : 0) << "\t"
+			<< (r.trips > 0 ? (double)r.waitTicks / r.trips : 0) << "\t"
+			<< (r.picked > 0 ? (double)r.latencyTicks / r.picked : 0) << "\t"
+			<< r.latencyMax << "\t"
+			<< r.collisions << "\t" << r.wallMs << std::endl;
+		for (auto& sla : r.classes) {
+			if (sla.latency.count > 0) {
+				std::cout << "\t" << sla.sla.name << " (target " << sla.sla.target << "): picked " << sla.latency.count
+					<< ", latency p50 " << sla.latency.p50 << ", p90 " << sla.latency.p90 << ", p99 " << sla.latency.p99
+					<< ", max " << sla.latency.max << ", missed " << (100.0 * sla.missed / sla.latency.count) << "%" << std::endl;
+			}
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,204 @@
+/**
+* Measures the routes robots drive to pick an order: the RouteOptimizer's
+* nearest-neighbour tour improved with 2-opt, against the closest-shelf-first
+* walk robots used before it, always driving to the nearest shelf still to visit.
+* Each run generates seeded random 80x80 layouts, picks orders of a number of
+* shelves at random from those a robot can reach, and plans every order both
+* ways from the robots' start to the exit.  Route length is counted in steps.
+*
+* Usage: routeBenchmark [options]
+*   --layouts <n>    random layouts generated (default 3)
+*   --orders <n>     orders planned per layout for each stop count (default 200)
+*   --stops <n>      shelves in each order (default: compare 5 up to 40)
+*   --seed <n>       seed of the first layout (default 1)
+*/
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "WarehouseCommon.h"
+#include "WarehouseObjects.h"
+#include "PathPlanner.h"
+#include "RouteOptimizer.h"
+
+#define BENCH_LAYOUTS 3
+#define BENCH_ORDERS 200
+#define BENCH_SEED 1
+#define BENCH_CROSS_AISLES 0.1    // chance a column is an aisle across the racks
+#define BENCH_SHELF_DENSITY 0.9   // chance a rack cell holds a shelf
+
+/**
+* Generates a random layout: walls around the edge, and racks two shelves deep
+* between aisles, broken by aisles across them at random columns and by gaps
+* where shelves are missing.  The robots start in one corner and leave from the
+* opposite one.
+* @param rng random number generator
+* @param winfo populated with the layout
+* @param rinfo populated with the start and exit
+*/
+void generate(std::mt19937& rng, WarehouseInfo& winfo, RobotInfo& rinfo) {
+	std::bernoulli_distribution crossAisle(BENCH_CROSS_AISLES);
+	std::bernoulli_distribution shelf(BENCH_SHELF_DENSITY);
+	winfo.rows = MAX_WAREHOUSE_SIZE;
+	winfo.cols = MAX_WAREHOUSE_SIZE;
+	winfo.docks.ndocks = 0;
+
+	// aisles run along both sides and across at random columns
+	std::vector<bool> aisle(winfo.cols, false);
+	for (int c = 0; c < winfo.cols; c++) {
+		aisle[c] = c <= 1 || c >= winfo.cols - 2 || crossAisle(rng);
+	}
+	for (int r = 0; r < winfo.rows; r++) {
+		for (int c = 0; c < winfo.cols; c++) {
+			bool edge = r == 0 || c == 0 || r == winfo.rows - 1 || c == winfo.cols - 1;
+			bool rack = r % 3 != 0 && r < winfo.rows - 2 && !aisle[c];
+			winfo.maze[c][r] = edge ? WALL_CHAR : (rack && shelf(rng) ? SHELF_CHAR : EMPTY_CHAR);
+		}
+	}
+
+	rinfo.nrobots = 0;
+	rinfo.startx = 1;
+	rinfo.starty = 1;
+	rinfo.endx = winfo.rows - 2;
+	rinfo.endy = winfo.cols - 2;
+	winfo.maze[rinfo.starty][rinfo.startx] = START_CHAR;
+	winfo.maze[rinfo.endy][rinfo.endx] = EXIT_CHAR;
+}
+
+/**
+* Orders stops the way robots did before the optimizer: from wherever the robot
+* is, drive to the closest shelf still to visit
+* @param planner path planner of the layout
+* @param start where the robot is
+* @param stops shelves to visit
+* @return indices into stops, in the order visited
+*/
+std::vector<size_t> closestFirst(const PathPlanner& planner, const Coordinates& start,
+	const std::vector<Coordinates>& stops) {
+
+	std::vector<size_t> order;
+	order.reserve(stops.size());
+	std::vector<bool> visited(stops.size(), false);
+	Coordinates at = start;
+	for (size_t k = 0; k < stops.size(); k++) {
+		size_t next = stops.size();
+		int best = PATH_UNREACHABLE + 1;
+		for (size_t i = 0; i < stops.size(); i++) {
+			int steps = planner.distanceBetween(at, stops[i]);
+			if (!visited[i] && steps < best) {
+				best = steps;
+				next = i;
+			}
+		}
+		visited[next] = true;
+		order.push_back(next);
+		at = stops[next];
+	}
+	return order;
+}
+
+int main(int argc, char* argv[]) {
+
+	int layouts = BENCH_LAYOUTS;
+	int orders = BENCH_ORDERS;
+	int nstops = 0;
+	unsigned int seed = BENCH_SEED;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--layouts" && i + 1 < argc && std::atoi(argv[i + 1]) > 0) {
+			layouts = std::atoi(argv[++i]);
+		}
+		else if (arg == "--orders" && i + 1 < argc && std::atoi(argv[i + 1]) > 0) {
+			orders = std::atoi(argv[++i]);
+		}
+		else if (arg == "--stops" && i + 1 < argc && std::atoi(argv[i + 1]) > 0) {
+			nstops = std::atoi(argv[++i]);
+		}
+		else if (arg == "--seed" && i + 1 < argc) {
+			seed = (unsigned int)std::atol(argv[++i]);
+		}
+	}
+
+	std::vector<int> counts = { 5, 10, 20, 40 };
+	if (nstops > 0) {
+		counts.assign(1, nstops);
+	}
+
+	// totals over every layout, by stop count
+	std::vector<long> routes(counts.size(), 0);
+	std::vector<long> closestSteps(counts.size(), 0), optimizedSteps(counts.size(), 0);
+	std::vector<double> closestUs(counts.size(), 0), optimizedUs(counts.size(), 0);
+
+	std::unique_ptr<WarehouseInfo> winfo(new WarehouseInfo());
+	RobotInfo rinfo;
+	for (int l = 0; l < layouts; l++) {
+		std::mt19937 rng(seed + l);
+		generate(rng, *winfo, rinfo);
+
+		auto start = std::chrono::steady_clock::now();
+		PathPlanner planner(*winfo, rinfo);
+		RouteOptimizer optimizer(planner);
+		double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		// shelves a robot can reach, and leave for the exit from
+		Coordinates begin(rinfo.startx, rinfo.starty);
+		Coordinates finish(rinfo.endx, rinfo.endy);
+		std::vector<Coordinates> reachable;
+		for (int r = 0; r < winfo->rows; r++) {
+			for (int c = 0; c < winfo->cols; c++) {
+				Coordinates shelf(r, c);
+				if (winfo->maze[c][r] == SHELF_CHAR && planner.distanceBetween(begin, shelf) != PATH_UNREACHABLE &&
+					planner.distanceBetween(shelf, finish) != PATH_UNREACHABLE) {
+					reachable.push_back(shelf);
+				}
+			}
+		}
+		std::cout << "Layout " << l + 1 << " (seed " << seed + l << "): " << reachable.size()
+			<< " reachable shelves, planner built in " << buildMs << " ms" << std::endl;
+		if (reachable.size() < (size_t)counts.back() || planner.distanceBetween(begin, finish) == PATH_UNREACHABLE) {
+			std::cout << "Too few reachable shelves, skipped" << std::endl;
+			continue;
+		}
+
+		for (size_t k = 0; k < counts.size(); k++) {
+			for (int o = 0; o < orders; o++) {
+				// distinct shelves, chosen at random
+				std::vector<Coordinates> stops;
+				for (int i = 0; i < counts[k]; i++) {
+					size_t j = i + rng() % (reachable.size() - i);
+					std::swap(reachable[i], reachable[j]);
+					stops.push_back(reachable[i]);
+				}
+
+				auto t0 = std::chrono::steady_clock::now();
+				std::vector<size_t> closest = closestFirst(planner, begin, stops);
+				auto t1 = std::chrono::steady_clock::now();
+				std::vector<size_t> optimized = optimizer.plan(begin, stops, finish);
+				auto t2 = std::chrono::steady_clock::now();
+
+				routes[k]++;
+				closestSteps[k] += optimizer.routeLength(begin, stops, closest, finish);
+				optimizedSteps[k] += optimizer.routeLength(begin, stops, optimized, finish);
+				closestUs[k] += std::chrono::duration<double, std::micro>(t1 - t0).count();
+				optimizedUs[k] += std::chrono::duration<double, std::micro>(t2 - t1).count();
+			}
+		}
+	}
+
+	if (routes[0] == 0) {
+		std::cout << "No layout could be planned over" << std::endl;
+		return 1;
+	}
+	std::cout << "stops\tclosest-first steps\toptimized steps\tshorter %\tclosest-first us\toptimized us" << std::endl;
+	for (size_t k = 0; k < counts.size(); k++) {
+		std::cout << counts[k] << "\t" << (double)closestSteps[k] / routes[k] << "\t" << (double)optimizedSteps[k] / routes[k] << "\t"
+			<< 100.0 * (closestSteps[k] - optimizedSteps[k]) / closestSteps[k] << "\t"
+			<< closestUs[k] / routes[k] << "\t" << optimizedUs[k] / routes[k] << std::endl;
+	}
+
+	return 0;
+}
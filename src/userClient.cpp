@@ -17,9 +17,10 @@
 static const char CLIENT_PRINT = '1';
 static const char CLIENT_SEARCH = '2';
 static const char CLIENT_ADD = '3';
-static const char CLIENT_ORDER = '4';
-static const char CLIENT_CANCEL = '5';
-static const char CLIENT_QUIT = '6';
+static const char CLIENT_ADD_SEVERAL = '4';
+static const char CLIENT_ORDER = '5';
+static const char CLIENT_CANCEL = '6';
+static const char CLIENT_QUIT = '7';
 
 // print menu options
 void print_menu() {
@@ -30,15 +31,30 @@ void print_menu() {
   std::cout << " (1) Print Shopping Cart" << std::endl;
   std::cout << " (2) Search Amazoom Catalog"<< std::endl;
   std::cout << " (3) Add Product to Shopping Cart" << std::endl;
-  std::cout << " (4) Place Order"  << std::endl;
-  std::cout << " (5) Cancel Order" << std::endl;
-  std::cout << " (6) Quit " << std::endl;
+  std::cout << " (4) Add Several Products to Shopping Cart" << std::endl;
+  std::cout << " (5) Place Order"  << std::endl;
+  std::cout << " (6) Cancel Order" << std::endl;
+  std::cout << " (7) Quit " << std::endl;
   std::cout << "=========================================" << std::endl;
   std::cout << "Enter number: ";
   std::cout.flush();
 
 }
 
+// receive a response, reporting if the server was too busy to handle the request
+// requestId selects the response to a pipelined request, 0 takes the next one
+std::unique_ptr<Message> recvResponse(UserClientApi &api, int requestId = 0) {
+	std::unique_ptr<Message> msgr = requestId != 0 ? api.recvResponse(requestId) : api.recvMessage();
+	if (msgr == nullptr) {
+		std::cout << "Lost connection to server." << std::endl;
+	}
+	else if (msgr->type() == MessageType::BUSY_RESPONSE) {
+		std::cout << "Server is busy, please try again." << std::endl;
+		return nullptr;
+	}
+	return msgr;
+}
+
 //print Order
 void do_print(std::vector<ItemEntry> &cart) {
 	double total = 0;
@@ -67,7 +83,10 @@ void do_search(UserClientApi &api) {
 	SearchMessage msg(itemName, itemID);
 	if (api.sendMessage(msg)) {
 		// get response
-		std::unique_ptr<Message> msgr = api.recvMessage();
+		std::unique_ptr<Message> msgr = recvResponse(api);
+		if (msgr == nullptr) {
+			return;
+		}
 		SearchResponseMessage& resp = (SearchResponseMessage&)(*msgr);
 
 		if (resp.status == MESSAGE_STATUS_OK) {
@@ -105,7 +124,10 @@ void do_add(UserClientApi &api, std::vector<ItemEntry> &cart) {
   AddMessage msg(item_name_regex, productID, quantity);
   if (api.sendMessage(msg)) {
     // get response
-    std::unique_ptr<Message> msgr = api.recvMessage();
+    std::unique_ptr<Message> msgr = recvResponse(api);
+    if (msgr == nullptr) {
+      return;
+    }
     AddResponseMessage& resp = (AddResponseMessage&)(*msgr);
 
     if (resp.status == MESSAGE_STATUS_OK) {
@@ -146,6 +168,68 @@ void do_add(UserClientApi &api, std::vector<ItemEntry> &cart) {
   std::cout << std::endl;
 }
 
+// adds an entry to the cart, just increasing the quantity if it is already there
+void add_to_cart(std::vector<ItemEntry> &cart, ItemEntry entry, int quantity) {
+	for (auto &itemincart : cart) {
+		if (itemincart.ID == entry.ID) {
+			itemincart.quantityAvailable += quantity;
+			return;
+		}
+	}
+	entry.quantityAvailable = quantity;
+	cart.push_back(entry);
+}
+
+// add several items to an order in a single request, all or nothing
+void do_add_several(UserClientApi &api, std::vector<ItemEntry> &cart) {
+	std::vector<ItemEntry> items;
+
+	std::cout << std::endl << "Add Several Products to Shopping Cart" << std::endl;
+	std::cout << "   Enter a product ID of 0 when done" << std::endl;
+	while (true) {
+		int productID;
+		int quantity;
+		std::cout << "   Product ID: ";
+		std::cin >> productID;
+		if (productID == 0) {
+			break;
+		}
+		std::cout << "   Quantity: ";
+		std::cin >> quantity;
+		items.push_back(ItemEntry("", quantity, productID, 0, 0));
+	}
+	if (items.size() == 0) {
+		return;
+	}
+
+	// send message to server and wait for response
+	BatchAddMessage msg(items);
+	int requestId = api.sendRequest(msg);
+	if (requestId != 0) {
+		std::unique_ptr<Message> msgr = recvResponse(api, requestId);
+		if (msgr == nullptr) {
+			return;
+		}
+		BatchAddResponseMessage& resp = (BatchAddResponseMessage&)(*msgr);
+
+		if (resp.status == MESSAGE_STATUS_OK) {
+			// results are in the order the items were sent
+			for (size_t i = 0; i < resp.results.size() && i < items.size(); i++) {
+				add_to_cart(cart, resp.results[i], items[i].quantityAvailable);
+			}
+			std::cout << std::endl << "   " << items.size() << " products added successfully." << std::endl;
+		}
+		else {
+			std::cout << "No products added, not enough stock of:" << std::endl;
+			for (auto &entry : resp.results) {
+				std::cout << "Product name: " << entry.itemName << " Product ID: " << entry.ID << " Available: " << entry.quantityAvailable << std::endl;
+			}
+		}
+	}
+
+	std::cout << std::endl;
+}
+
 void do_order(UserClientApi &api, std::vector<ItemEntry> cart) {
 	if (cart.size() != 0) {
 		char answer;
@@ -158,11 +242,19 @@ void do_order(UserClientApi &api, std::vector<ItemEntry> cart) {
 			std::cout << "Order not placed." << std::endl;
 		}
 		else if (answer == 'Y') {
+			std::string sla;
+			std::cout << "Delivery (express/standard/economy): ";
+			std::cin >> sla;
+
 			//send command
-			ConfirmOrder msg = ConfirmOrder(cart);
+			ConfirmOrder msg = ConfirmOrder(cart, sla);
 			if (api.sendMessage(msg)) {
 				// get response
-				std::unique_ptr<Message> msgr = api.recvMessage();
+				std::unique_ptr<Message> msgr = recvResponse(api);
+				if (msgr == nullptr) {
+					std::cout << "Your order has not been placed." << std::endl;
+					return;
+				}
 				ConfirmOrderResponseMessage& resp = (ConfirmOrderResponseMessage&)(*msgr);
 
 				if (resp.status == MESSAGE_STATUS_OK) {
@@ -195,7 +287,10 @@ void do_cancel(UserClientApi &api) {
 	CancelOrder msg(orderNum);
 	if (api.sendMessage(msg)) {
 		// get response
-		std::unique_ptr<Message> msgr = api.recvMessage();
+		std::unique_ptr<Message> msgr = recvResponse(api);
+		if (msgr == nullptr) {
+			return;
+		}
 		CancelOrderResponseMessage& resp = (CancelOrderResponseMessage&)(*msgr);
 
 		if (resp.status == MESSAGE_STATUS_OK) {
@@ -214,7 +309,15 @@ void sayGoodbye(UserClientApi &api) {
 }
 
 
-int main() {
+int main(int argc, char* argv[]) {
+
+  // "--binary" selects the compact binary encoding instead of JSON
+  bool binary = false;
+  for (int i = 1; i < argc; i++) {
+    if (std::string(argv[i]) == "--binary") {
+      binary = true;
+    }
+  }
 
   // start client
   cpen333::process::socket socket("localhost", MUSIC_LIBRARY_SERVER_PORT);
@@ -224,9 +327,11 @@ int main() {
   // if we open the socket successfully, continue
   if (socket.open()) {
     std::cout << "connected." << std::endl;
+    // requests are small and may be pipelined, send them without waiting for ACKs
+    socket.set_no_delay(true);
 
     // create API handler
-    JsonUserClientApi api(std::move(socket));
+    JsonUserClientApi api(std::move(socket), binary);
 
 	//create shopping cart
 	std::vector<ItemEntry> shoppingCart;
@@ -250,6 +355,9 @@ int main() {
           break;
         case CLIENT_ADD:
           do_add(api, shoppingCart);
+          break;
+        case CLIENT_ADD_SEVERAL:
+          do_add_several(api, shoppingCart);
           break;
 		case CLIENT_ORDER:
 		  do_order(api, shoppingCart);
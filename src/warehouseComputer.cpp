@@ -9,9 +9,13 @@
 #include <fstream>
 #include <iostream>
 #include <thread>
+#include <chrono>
 #include <memory>
 #include <mutex>
 #include <limits>
+#include <condition_variable>
+#include <string>
+#include <cstdlib>
 
 #include "JsonUserClientApi.h"
 #include "Warehouse.h"
@@ -22,9 +26,16 @@
 #include "Common_truck.h"
 #include "safe_printf.h"
 #include "Robot.h"
+#include "RobotDispatcher.h"
+#include "PathPlanner.h"
+#include "ReservationTable.h"
+#include "DistanceTable.h"
+#include "SlottingOptimizer.h"
 #include "WarehouseCommon.h"
 #include "WarehouseInventory.h"
 #include "JsonConverter.h"
+#include "EventLoopServer.h"
+#include "WorkerPool.h"
 
 #include <cpen333/process/socket.h>
 #include <cpen333/process/mutex.h>
@@ -37,7 +48,10 @@
 static const char USER_CHECK_ORDER = '1';
 static const char USER_CHECK_ITEM = '2';
 static const char USER_ADD_ROBOT = '3';
-static const char USER_QUIT = '4';
+static const char USER_SERVER_STATS = '4';
+static const char USER_SLOTTING = '5';
+static const char USER_SLA = '6';
+static const char USER_QUIT = '7';
 
 // print menu options
 void print_menu() {
@@ -48,7 +62,10 @@ void print_menu() {
 	std::cout << " (1) Check Order Status" << std::endl;
 	std::cout << " (2) Check Item Availability" << std::endl;
 	std::cout << " (3) Add Robot" << std::endl;
-	std::cout << " (4) Quit " << std::endl;
+	std::cout << " (4) Server Statistics" << std::endl;
+	std::cout << " (5) Shelf Usage and Re-slotting" << std::endl;
+	std::cout << " (6) Order Latency by Service Class" << std::endl;
+	std::cout << " (7) Quit " << std::endl;
 	std::cout << "=========================================" << std::endl;
 	std::cout << "Enter number: ";
 	std::cout.flush();
@@ -56,160 +73,305 @@ void print_menu() {
 }
 
  /**
- * Main thread function for handling communication with a single remote
- * client.
+ * Reacts to a single message from a client, independent of how the message
+ * was received.
  *
  * @param lib shared library
- * @param api communication interface layer
+ * @param orderList shared list of confirmed orders
+ * @param msg message received from the client
  * @param id client id for printing messages to the console
+ * @param pick queue of orders for the robots to pick
+ * @return response to send back to the client, nullptr if there is none
  */
-void service(WarehouseInventory &lib, OrderList &orderList, UserClientApi &&api, int id, PickupQueue &pick) {
+std::unique_ptr<Message> handleMessage(WarehouseInventory &lib, OrderList &orderList, Message &msg, int id, PickupQueue &pick) {
 
-	cpen333::process::mutex mutex("Server_Mutex");
-	std::unique_lock<cpen333::process::mutex> memLock(mutex);
-	memLock.unlock();
+	// react and respond to message
+	MessageType type = msg.type();
+	switch (type) {
 
-	std::cout << "Client " << id << " connected" << std::endl;
+	case MessageType::SEARCH: {
+		// process "search" message
+		// get reference to SEARCH
+		SearchMessage &search = (SearchMessage &)(msg);
 
-	// receive message
-	std::unique_ptr<Message> msg = api.recvMessage();
-	mutex.lock();
-	/*
-	Lock Mutex after receiving new data. This prevents any threads inserting data into
-	the socket in between receiving and sending response message.
-	*/
+		std::cout << "Client " << id << " searching for: "
+			<< search.itemName << std::endl;
 
-	// continue while we don't have an error
-	while (msg != nullptr) {
+		// search library
+		std::vector<ItemEntry> results;
+		results = lib.find(search.itemName, search.itemID);
+
+		// send response
+		if (results.size() > 0) {
+			return std::unique_ptr<Message>(new SearchResponseMessage(std::move(results), MESSAGE_STATUS_OK));
+		}
+		return std::unique_ptr<Message>(new SearchResponseMessage(std::move(results), MESSAGE_STATUS_ERROR));
+	}
 
-		// react and respond to message
-		MessageType type = msg->type();
-		switch (type) {
+	case MessageType::ADD: {
+		// process "add" message
+		// get reference to ADD
+		AddMessage &add = (AddMessage &)(msg);
+		std::cout << "Client " << id << " adding item to order: " << add.itemName << std::endl;
 
-		case MessageType::SEARCH: {
-			// process "search" message
-			// get reference to SEARCH
-			SearchMessage &search = (SearchMessage &)(*msg);
 
-			std::cout << "Client " << id << " searching for: "
-				<< search.itemName << std::endl;
+		bool success = false;
+		//check if item exists and if available
+		std::vector<ItemEntry> results;
+		results = lib.find(add.itemName, add.itemID);
 
-			// search library
-			std::vector<ItemEntry> results;
-			results = lib.find(search.itemName, search.itemID);
+		if (results.size() == 1) {
+			success = lib.holdItem(add.itemID, add.itemQuantity);
+		}
 
-			// send response
-			if (results.size() > 0) {
-				api.sendMessage(SearchResponseMessage(results, MESSAGE_STATUS_OK));
+		// send response
+		if (success == true) {
+			std::cout <<add.itemQuantity<< " x " << add.itemName << " placed on hold successfully!" << std::endl;
+
+			//updated result in library after placing product on hold
+			int available = 0, onHold = 0;
+			lib.visit_id(add.itemID, [&](const ItemEntry &entry) {
+				available = entry.quantityAvailable;
+				onHold = entry.quantityOnHold;
+			});
+
+			if (available <= LOW_STOCK) {
+			std::cout << add.itemName << " is low on stock " << std::endl;
+			std::cout << "Quantity Available: "<< available << std::endl;
+			std::cout << "Quantity On Hold: " << onHold << std::endl;
 			}
-			else {
-				api.sendMessage(SearchResponseMessage(results, MESSAGE_STATUS_ERROR));
+			return std::unique_ptr<Message>(new AddResponseMessage(std::move(results), MESSAGE_STATUS_OK, "Item placed on hold successfully!"));
+		}
+		std::cout << "Error: Client" << id << "unable to add product" << std::endl;
+		return std::unique_ptr<Message>(new AddResponseMessage(std::move(results), MESSAGE_STATUS_ERROR, "Unable to add product"));
+	}
+
+	case MessageType::BATCH_ADD: {
+		// process "batch add" message, holding the whole cart or nothing
+		BatchAddMessage &batch = (BatchAddMessage &)(msg);
+		std::cout << "Client " << id << " adding " << batch.items.size() << " items to order" << std::endl;
+		if (!batch.unknownItem.empty()) {
+			std::cout << "Error: Client " << id << " asked for unknown item " << batch.unknownItem << std::endl;
+			return std::unique_ptr<Message>(new BatchAddResponseMessage(std::vector<ItemEntry>(), MESSAGE_STATUS_ERROR, "Unknown item"));
+		}
+
+		std::vector<std::pair<int, int>> holds;
+		holds.reserve(batch.items.size());
+		for (auto &item : batch.items) {
+			holds.push_back(std::make_pair(item.ID, item.quantityAvailable));
+		}
+
+		std::vector<ItemEntry> results;
+		results.reserve(batch.items.size());
+		if (lib.holdItems(holds)) {
+			//updated results in library after placing products on hold
+			for (auto &item : batch.items) {
+				lib.visit_id(item.ID, [&](const ItemEntry &entry) {
+					results.push_back(entry);
+				});
+				const ItemEntry &entry = results.back();
+				if (entry.quantityAvailable <= LOW_STOCK) {
+					std::cout << entry.itemName << " is low on stock " << std::endl;
+					std::cout << "Quantity Available: " << entry.quantityAvailable << std::endl;
+					std::cout << "Quantity On Hold: " << entry.quantityOnHold << std::endl;
+				}
 			}
+			std::cout << batch.items.size() << " items placed on hold successfully!" << std::endl;
+			return std::unique_ptr<Message>(new BatchAddResponseMessage(std::move(results), MESSAGE_STATUS_OK, "Items placed on hold successfully!"));
+		}
 
-			break;
+		// report the items holding us back
+		for (auto &item : batch.items) {
+			bool found = lib.visit_id(item.ID, [&](const ItemEntry &entry) {
+				if (entry.quantityAvailable < item.quantityAvailable) {
+					results.push_back(entry);
+				}
+			});
+			if (!found) {
+				item.quantityAvailable = 0;
+				results.push_back(std::move(item));
+			}
 		}
+		std::cout << "Error: Client" << id << "unable to add products" << std::endl;
+		return std::unique_ptr<Message>(new BatchAddResponseMessage(std::move(results), MESSAGE_STATUS_ERROR, "Unable to add products"));
+	}
 
-		
-		case MessageType::ADD: {
-			// process "add" message
-			// get reference to ADD
-			AddMessage &add = (AddMessage &)(*msg);
-			std::cout << "Client " << id << " adding item to order: " << add.itemName << std::endl;
+	case MessageType::CONFIRM_ORDER: {
+		ConfirmOrder &confirm = (ConfirmOrder &)(msg);
+		if (!confirm.unknownItem.empty()) {
+			std::cout << "Error: Client " << id << " ordered unknown item " << confirm.unknownItem << std::endl;
+			return std::unique_ptr<Message>(new ConfirmOrderResponseMessage(-1, MESSAGE_STATUS_ERROR, "Unknown item"));
+		}
+		 
+		//record the order, moving the cart into the order list
+		std::vector<Item> items = OrderEntry::entrytoitem(confirm.order);
+		int orderNum = orderList.addEntry(std::move(confirm.order));
 
+		//generate an order, picked as soon as its service class asks
+		Order order(std::move(items), orderNum);
+		order.setSlaClass(pick.slaClass(confirm.sla));
 
-			bool success = false;
-			//check if item exists and if available
-			std::vector<ItemEntry> results;
-			results = lib.find(add.itemName, add.itemID);
+		//add to pick queue for robots
+		pick.addToPQueue(std::move(order));
 
-			if (results.size() == 1) {
-				success = lib.holdItem(add.itemID, add.itemQuantity);
-			}
+		std::cout << "Client " << id << " confirmed order #" << orderNum <<std::endl;
+		return std::unique_ptr<Message>(new ConfirmOrderResponseMessage(orderNum, MESSAGE_STATUS_OK));
+	}
 
-			// send response
-			if (success == true) {
-				api.sendMessage(AddResponseMessage(results, MESSAGE_STATUS_OK, "Item placed on hold successfully!"));
-				std::cout <<add.itemQuantity<< " x " << add.itemName << " placed on hold successfully!" << std::endl;
+	case MessageType::CANCEL_ORDER: {
+		// process "cancel" message
+		// get reference to cancel
+		CancelOrder &cancel = (CancelOrder &)(msg);
 
-				//updated result in library after placing product on hold
-				results = lib.find(add.itemName, add.itemID);
+		// check and cancel in one step so two clients can't both cancel
+		if (orderList.changeStatus(cancel.orderNum, "Confirmed", "Cancelled"))
+		{
+			std::cout << "Client " << id << " cancelled order #" << cancel.orderNum << std::endl;
+			return std::unique_ptr<Message>(new CancelOrderResponseMessage(MESSAGE_STATUS_OK, "Cancelled"));
+		}
 
-				if (results[0].quantityAvailable <= LOW_STOCK) {
-				std::cout << results[0].itemName << " is low on stock " << std::endl;
-				std::cout << "Quantity Available: "<< results[0].quantityAvailable << std::endl;
-				std::cout << "Quantity On Hold: " << results[0].quantityOnHold << std::endl;
-				}
-			}
-			else {
-				api.sendMessage(AddResponseMessage(results, MESSAGE_STATUS_ERROR, "Unable to add product"));
-				std::cout << "Error: Client" << id << "unable to add product" << std::endl;
-			}
-			break;
+		std::string status;
+		bool found = orderList.visitOrder(cancel.orderNum, [&](const OrderEntry &order) {
+			status = order.status;
+		});
+		if (!found) {
+			std::cout << "Client " << id << " tried to cancel unknown order #" << cancel.orderNum << std::endl;
+			return std::unique_ptr<Message>(new CancelOrderResponseMessage(MESSAGE_STATUS_ERROR, "Order not found"));
+		}
+		else if (status == "Enroute to Delivery") 
+		{
+			std::cout << "Client " << id << "'s order #" << cancel.orderNum << "unable to be cancelled. Currently enroute to delivery"<<std::endl;
+			return std::unique_ptr<Message>(new CancelOrderResponseMessage(MESSAGE_STATUS_ERROR, "Enroute to Delivered"));
 		}
+		else if (status == "Cancelled") {
+			std::cout << "Client " << id << " has already cancelled order #" << cancel.orderNum << std::endl;
+			return std::unique_ptr<Message>(new CancelOrderResponseMessage(MESSAGE_STATUS_ERROR, "Already Cancelled"));
+		}
+		std::cout << "Client " << id << "'s order #" << cancel.orderNum << " unable to be cancelled. Currently " << status << std::endl;
+		return std::unique_ptr<Message>(new CancelOrderResponseMessage(MESSAGE_STATUS_ERROR, status));
+	}
+	
+	case MessageType::GOODBYE: {
+		// process "goodbye" message
+		std::cout << "Client " << id << " closing" << std::endl;
+		break;
+	}
+	default: {
+		std::cout << "Client " << id << " sent invalid message" << std::endl;
+	}
+	}
 
-		case MessageType::CONFIRM_ORDER: {
-			ConfirmOrder &confirm = (ConfirmOrder &)(*msg);
-			 
-			//find order entry associated with ordernum
-			int orderNum = orderList.addEntry(confirm.order);
-			OrderEntry entry = orderList.searchOrder(orderNum);
-			std::vector<Item> items = entry.entrytoitem(entry);
+	return std::unique_ptr<Message>(nullptr);
+}
 
-			//generate an order 
-			Order order(items, orderNum);
+ /**
+ * Builds the response to a request that could not be handled, e.g. because
+ * handleMessage threw on an invalid search expression, so a client waiting on
+ * the request is still answered.
+ *
+ * @param request message received from the client
+ * @param info reason the request failed
+ * @return error response of the type the client expects, carrying the request's ID,
+ *         nullptr if the request has no response
+ */
+std::unique_ptr<Message> errorResponse(const Message &request, const std::string &info) {
+	std::unique_ptr<Message> response;
+	switch (request.type()) {
+	case MessageType::SEARCH:
+		response.reset(new SearchResponseMessage(std::vector<ItemEntry>(), MESSAGE_STATUS_ERROR, info));
+		break;
+	case MessageType::ADD:
+		response.reset(new AddResponseMessage(std::vector<ItemEntry>(), MESSAGE_STATUS_ERROR, info));
+		break;
+	case MessageType::BATCH_ADD:
+		response.reset(new BatchAddResponseMessage(std::vector<ItemEntry>(), MESSAGE_STATUS_ERROR, info));
+		break;
+	case MessageType::CONFIRM_ORDER:
+		response.reset(new ConfirmOrderResponseMessage(-1, MESSAGE_STATUS_ERROR, info));
+		break;
+	case MessageType::CANCEL_ORDER:
+		response.reset(new CancelOrderResponseMessage(MESSAGE_STATUS_ERROR, info));
+		break;
+	default:
+		return response;
+	}
+	response->requestId = request.requestId;
+	return response;
+}
 
-			//add to pick queue for robots
-			pick.addToPQueue(order);
+ /**
+ * Main thread function for handling communication with a single remote
+ * client.
+ *
+ * @param lib shared library
+ * @param api communication interface layer
+ * @param id client id for printing messages to the console
+ * @param workers pool handling client requests
+ */
+void service(WarehouseInventory &lib, OrderList &orderList, UserClientApi &&api, int id, PickupQueue &pick, WorkerPool &workers) {
 
-			api.sendMessage(ConfirmOrderResponseMessage(orderNum, MESSAGE_STATUS_OK));
+	/*
+	No server-wide lock: each client owns its socket, the inventory locks per item
+	and the order list has its own lock, so clients only contend on shared SKUs.
+	*/
+	std::cout << "Client " << id << " connected" << std::endl;
+
+	// requests are handed to the pool without waiting, so a client can pipeline
+	// them; responses are sent by the workers in whatever order they finish
+	std::mutex sendMutex;
+	std::condition_variable idle;
+	int outstanding = 0;
 
-			std::cout << "Client " << id << " confirmed order #" << orderNum <<std::endl;
+	// receive message
+	std::unique_ptr<Message> msg = api.recvMessage();
+
+	// continue while we don't have an error
+	while (msg != nullptr) {
+
+		if (msg->type() == MessageType::GOODBYE) {
+			handleMessage(lib, orderList, *msg, id, pick);
 			break;
 		}
 
-		case MessageType::CANCEL_ORDER: {
-			// process "cancel" message
-			// get reference to cancel
-			CancelOrder &cancel = (CancelOrder &)(*msg);
-			
-			OrderEntry &order = orderList.searchOrder(cancel.orderNum);
-
-			if (order.status == "Confirmed") 
-			{
-				api.sendMessage(CancelOrderResponseMessage(MESSAGE_STATUS_OK, "Cancelled"));
-				orderList.changeStatus(cancel.orderNum, "Cancelled");
-				std::cout << "Client " << id << " cancelled order #" << cancel.orderNum << std::endl;
-			}
-			else if (order.status == "Enroute to Delivery") 
-			{
-				api.sendMessage(CancelOrderResponseMessage(MESSAGE_STATUS_ERROR, "Enroute to Delivered"));
-				std::cout << "Client " << id << "'s order #" << cancel.orderNum << "unable to be cancelled. Currently enroute to delivery"<<std::endl;
+		std::shared_ptr<Message> request(std::move(msg));
+		{
+			std::lock_guard<std::mutex> lock(sendMutex);
+			outstanding++;
+		}
+		bool admitted = workers.trySubmit([&lib, &orderList, &api, id, &pick, &sendMutex, &idle, &outstanding, request]() {
+			std::unique_ptr<Message> response;
+			try {
+				response = handleMessage(lib, orderList, *request, id, pick);
 			}
-			else if (order.status == "Cancelled") {
-				api.sendMessage(CancelOrderResponseMessage(MESSAGE_STATUS_ERROR, "Already Cancelled"));
-				std::cout << "Client " << id << " has already cancelled order #" << cancel.orderNum << std::endl;
+			catch (std::exception& e) {
+				std::cout << "Client " << id << " request failed: " << e.what() << std::endl;
+				response = errorResponse(*request, e.what());
 			}
-			break;
 
-		}
-		
-		case MessageType::GOODBYE: {
-			// process "goodbye" message
-			std::cout << "Client " << id << " closing" << std::endl;
-			return;
-		}
-		default: {
-			std::cout << "Client " << id << " sent invalid message" << std::endl;
-		}
+			std::lock_guard<std::mutex> lock(sendMutex);
+			if (response != nullptr) {
+				response->requestId = request->requestId;
+				api.sendMessage(*response);
+			}
+			outstanding--;
+			idle.notify_all();
+		});
+		if (!admitted) {
+			std::cout << "Client " << id << " turned away, server busy" << std::endl;
+			BusyResponseMessage busy;
+			busy.requestId = request->requestId;
+			std::lock_guard<std::mutex> lock(sendMutex);
+			api.sendMessage(busy);
+			outstanding--;
 		}
 
 		// receive next message
-
-		//very inefficient mutex locking lol
-		mutex.unlock();
 		msg = api.recvMessage();
-		mutex.lock();
 	}
+
+	// the workers use the connection, wait for them before it is closed
+	std::unique_lock<std::mutex> lock(sendMutex);
+	idle.wait(lock, [&outstanding]() { return outstanding == 0; });
 }
  
 
@@ -223,7 +385,7 @@ void do_check_order(OrderList &list) {
 		std::cout << "Items in order:\n";
 		std::cout << "Item Name\tItemID\t\tQuantity Ordered\t\n";
 
-		for (auto item: entry.itemList) {
+		for (auto &item: entry.itemList) {
 		std::cout << item.itemName << "\t" << item.ID << "\t\t" << item.quantityAvailable << "\t" << std::endl;
 
 		}
@@ -233,7 +395,7 @@ void do_check_order(OrderList &list) {
 	}
 }
 
-void do_check_item(WarehouseInventory &lib) {
+void do_check_item(WarehouseInventory &lib, Warehouse &warehouse) {
 	int itemID;
 
 	std::cout << "Item ID: ";
@@ -242,15 +404,25 @@ void do_check_item(WarehouseInventory &lib) {
 	ItemEntry entry = lib.find_id(itemID);
 
 	if (entry.ID == itemID) {
+		{
+			cpen333::process::mutex mutex(WAREHOUSE_MUTEX_NAME);
+			std::lock_guard<decltype(mutex)> lock(mutex);
+			entry.shelfLocations = warehouse.locate(itemID);
+		}
 		std::cout << "Quantity Available: " << entry.quantityAvailable << "\t Quantity On Hold: " << entry.quantityOnHold << "\n";
+		std::cout << "Shelf locations:";
+		for (auto &coord : entry.shelfLocations) {
+			std::cout << " " << coord;
+		}
+		std::cout << "\n";
 	}
 	else {
 		std::cout << "ERROR: Invalid Item\n";
 	}
 }
 
-void do_add_robot(std::vector<Robot*> &robots, Warehouse &warehouse, RestockingQueue &restock,
-	DeliveryCompQueue &compQueue, DeliveryTruckQueue &truckQueue, PickupQueue &pickup) {
+void do_add_robot(std::vector<Robot*> &robots, Warehouse &warehouse, PathPlanner &planner, ReservationTable &reservations,
+	RobotDispatcher &dispatcher, DeliveryCompQueue &compQueue) {
 	cpen333::process::shared_object<SharedData> memory(WAREHOUSE_MEMORY_NAME);
 	cpen333::process::mutex mutex(WAREHOUSE_MUTEX_NAME);
 
@@ -258,12 +430,77 @@ void do_add_robot(std::vector<Robot*> &robots, Warehouse &warehouse, RestockingQ
 		std::lock_guard<decltype(mutex)> mylock(mutex);
 		memory->rinfo.nrobots = memory->rinfo.nrobots + 1;
 		int id_ = memory->rinfo.nrobots;
-		robots.push_back(new Robot(id_, std::ref(warehouse), std::ref(restock), std::ref(pickup), std::ref(compQueue), std::ref(truckQueue)));
+		robots.push_back(new Robot(id_, std::ref(warehouse), std::ref(planner), std::ref(reservations), std::ref(dispatcher), std::ref(compQueue)));
 		robots.back()->start();
 	}
 
 }
 
+void do_server_stats(WorkerPool &workers) {
+	WorkerPoolStats stats = workers.stats();
+	std::cout << "Worker threads: " << stats.workers << "\n";
+	std::cout << "Queue depth: " << stats.queueDepth << " / " << stats.queueCapacity << "\t Peak: " << stats.peakDepth << "\n";
+	std::cout << "Requests accepted: " << stats.accepted << "\t Completed: " << stats.completed << "\t Rejected (busy): " << stats.rejected << std::endl;
+}
+
+void do_sla_stats(RobotDispatcher &dispatcher) {
+	std::cout << "Ticks from order to picked:" << std::endl;
+	for (auto &report : dispatcher.slaReport()) {
+		std::cout << report.sla.name << " (target " << report.sla.target << "):\t Picked: " << report.latency.count
+			<< "\t p50: " << report.latency.p50 << "\t p90: " << report.latency.p90 << "\t p99: " << report.latency.p99
+			<< "\t Max: " << report.latency.max << "\t Missed target: " << report.missed << std::endl;
+	}
+}
+
+void do_slotting(Warehouse &warehouse, SlottingOptimizer &slotting, SlottingJob &job) {
+	CapacityStats stats;
+	{
+		cpen333::process::mutex mutex(WAREHOUSE_MUTEX_NAME);
+		std::lock_guard<decltype(mutex)> lock(mutex);
+		stats = warehouse.capacityStats();
+	}
+	std::cout << "Shelves: " << stats.shelves << "\t Empty: " << stats.emptyShelves << "\t Weight stored: " << stats.used
+		<< " / " << stats.capacity << " (" << (int)(100 * stats.fillRatio) << "% full)\n";
+	std::cout << "Shelves by fill:";
+	for (int i = 0; i < CAPACITY_HISTOGRAM_BINS; i++) {
+		std::cout << "  " << 100 * i / CAPACITY_HISTOGRAM_BINS << "-" << 100 * (i + 1) / CAPACITY_HISTOGRAM_BINS << "%: " << stats.histogram[i];
+	}
+	std::cout << "\n\n";
+
+	SlottingReport report = job.latest();
+	if (report.moves.empty()) {
+		// nothing proposed in the background yet, propose now
+		cpen333::process::mutex mutex(WAREHOUSE_MUTEX_NAME);
+		std::lock_guard<decltype(mutex)> lock(mutex);
+		report = slotting.propose(warehouse);
+	}
+
+	std::cout << "Item Name\tItemID\tQuantity\tFrom\t\tTo\t\tSteps Saved\n";
+	for (auto &move : report.moves) {
+		Coordinates from = warehouse.Shelves[move.from].shelfLocation();
+		Coordinates to = warehouse.Shelves[move.to].shelfLocation();
+		std::cout << move.itemName << "\t" << move.itemID << "\t" << move.quantity << "\t\t" << from << "\t" << to << "\t" << move.saving << "\n";
+	}
+	std::cout << "Pick travel so far: " << report.currentTravel << " steps, after moves: " << report.plannedTravel << " steps";
+	if (report.currentTravel > 0) {
+		std::cout << " (" << 100 * (report.currentTravel - report.plannedTravel) / report.currentTravel << "% less)";
+	}
+	std::cout << std::endl;
+
+	if (!report.moves.empty()) {
+		char answer = 'n';
+		std::cout << "Make these moves? (y/n): ";
+		std::cin >> answer;
+		if (answer == 'y' || answer == 'Y') {
+			cpen333::process::mutex mutex(WAREHOUSE_MUTEX_NAME);
+			std::lock_guard<decltype(mutex)> lock(mutex);
+			int moved = slotting.apply(warehouse, report);
+			job.clear();
+			std::cout << moved << " of " << report.moves.size() << " moves made" << std::endl;
+		}
+	}
+}
+
 void do_quit() {
 	std::cout << "Goodbye user! :(" << std::endl;
 }
@@ -271,11 +508,12 @@ void do_quit() {
 /** 
 * Provides a User interface to access warehouse databases
 */
-void warehouseUI(std::vector<Robot*> &robots,WarehouseInventory &lib, OrderList &orderList, Warehouse &warehouse, RestockingQueue &restock,
-	DeliveryCompQueue &compQueue, DeliveryTruckQueue &truckQueue, PickupQueue &pickup) 
+void warehouseUI(std::vector<Robot*> &robots,WarehouseInventory &lib, OrderList &orderList, Warehouse &warehouse, PathPlanner &planner, ReservationTable &reservations, RobotDispatcher &dispatcher,
+	DeliveryCompQueue &compQueue, WorkerPool &workers, SlottingOptimizer &slotting) 
 {
 	
 	char cmd=0;
+	SlottingJob slottingJob(slotting, warehouse);
 	
 	std::cout << "Hello user! :)" << std::endl;
 	while (cmd != USER_QUIT) {
@@ -286,10 +524,19 @@ void warehouseUI(std::vector<Robot*> &robots,WarehouseInventory &lib, OrderList
 			do_check_order(orderList);
 			break;
 		case USER_CHECK_ITEM:
-			do_check_item(lib);
+			do_check_item(lib, warehouse);
 			break; 
 		case USER_ADD_ROBOT:
-			do_add_robot(robots, warehouse, restock,compQueue,truckQueue,pickup);
+			do_add_robot(robots, warehouse, planner, reservations, dispatcher, compQueue);
+			break;
+		case USER_SERVER_STATS:
+			do_server_stats(workers);
+			break;
+		case USER_SLOTTING:
+			do_slotting(warehouse, slotting, slottingJob);
+			break;
+		case USER_SLA:
+			do_sla_stats(dispatcher);
 			break;
 		case USER_QUIT: 
 			do_quit();
@@ -299,6 +546,8 @@ void warehouseUI(std::vector<Robot*> &robots,WarehouseInventory &lib, OrderList
 		}
 	}
 
+	// wake up idle robots so they can finish
+	dispatcher.close();
 	for (auto& PickingRobot : robots) {
 		PickingRobot->join();
 	}
@@ -328,6 +577,31 @@ WarehouseInventory load_inventory(const std::string& filename) {
 	}
 }
 
+/**
+* Loads the service classes orders are picked by from a JSON file, a list of
+* {"name": ..., "target": ...} objects, most urgent first
+* @param filename file to load the classes from
+* @return service classes, the default ones if the file cannot be read
+*/
+std::vector<SlaClass> load_sla_classes(const std::string& filename) {
+
+	std::vector<SlaClass> classes;
+	std::ifstream fin(filename);
+	if (fin.is_open()) {
+		JSON j;
+		fin >> j;
+		for (auto &jsla : j) {
+			std::string name = jsla["name"];
+			long target = jsla["target"];
+			classes.push_back(SlaClass{ name, target });
+		}
+	}
+	else {
+		std::cerr << "Failed to open file: " << filename << ", using the default service classes" << std::endl;
+	}
+	return classes.empty() ? defaultSlaClasses() : classes;
+}
+
 /**
 * Reads a warehouse from a filename and populates the warehouse
 * @param filename file to load warehouse from
@@ -383,22 +657,19 @@ void load_layout(const std::string& filename, WarehouseInfo &winfo, RobotInfo &r
 /**
 * Loads items from a JSON file
 * @param filename file to load items from
+* @param slotting chooses the shelves items go on
 * @return warehouse
 */
-Warehouse load_warehouse(const std::string& filename, Warehouse warehouse) {
+Warehouse load_warehouse(const std::string& filename, Warehouse warehouse, const SlottingOptimizer &slotting) {
 
 	std::ifstream fin(filename);
 	if (fin.is_open()) {
 		JSON j;
 		fin >> j;
 		std::vector<Item> items = JsonConverter::parseItems(j);
-
-		for (int i = 0; i < items.size(); i++) {
-			warehouse.Shelves[i].storeItem(items[i]);
-
-			if (i == warehouse.Shelves.size() - 1) {
-				i = 0;
-			}
+		int unplaced = slotting.slot(warehouse, items);
+		if (unplaced > 0) {
+			std::cerr << unplaced << " items did not fit on the shelves" << std::endl;
 		}
 		return warehouse;
 	}
@@ -477,7 +748,7 @@ void truckMonitor(Warehouse &warehouse, OrderList &orderList, RestockingQueue &r
 			if (memory->dockBay[lowestDock].isDeliveryTruck) {
 				Order newOrder = completedOrdersQueue.removeFromDCQueue();
 				orderList.changeStatus(newOrder.getOrderNum(), "LOADING");
-				sendToTruckQueue.addToDTQueue(tCommand(newOrder, lowestDock));
+				sendToTruckQueue.addToDTQueue(tCommand(std::move(newOrder), lowestDock));
 			}
 			else {
 				std::vector<Item> truckList = getTruckList(".\data\restocktruck.json");
@@ -488,7 +759,55 @@ void truckMonitor(Warehouse &warehouse, OrderList &orderList, RestockingQueue &r
 
 }
 
-int main() {
+/**
+* Server options:
+*   --event-loop [threads]   service clients from a fixed pool of epoll reactor
+*                            threads instead of one thread per client (Linux only)
+*   --workers <n>            threads handling client requests (default: one per core)
+*   --queue <n>              requests allowed to wait for a worker before clients
+*                            are told the server is busy
+*   --no-delay               disable Nagle's algorithm on client connections
+*   --cork                   with --event-loop, cork a connection while the replies
+*                            queued for it are written, so they leave in full packets
+*   --time-scale <x>         run the robots x times faster than real time
+*/
+int main(int argc, char* argv[]) {
+
+	bool eventLoop = false;
+	size_t reactorThreads = EVENT_LOOP_THREADS;
+	size_t workerThreads = 0;
+	size_t workerQueue = WORKER_QUEUE_CAPACITY;
+	bool noDelay = false;
+	bool cork = false;
+	double timeScale = 1.0;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--event-loop") {
+			eventLoop = true;
+			if (i + 1 < argc && std::atoi(argv[i + 1]) > 0) {
+				reactorThreads = std::atoi(argv[++i]);
+			}
+		}
+		else if (arg == "--workers" && i + 1 < argc) {
+			workerThreads = std::atoi(argv[++i]);
+		}
+		else if (arg == "--queue" && i + 1 < argc && std::atoi(argv[i + 1]) > 0) {
+			workerQueue = std::atoi(argv[++i]);
+		}
+		else if (arg == "--no-delay") {
+			noDelay = true;
+		}
+		else if (arg == "--cork") {
+			cork = true;
+		}
+		else if (arg == "--time-scale" && i + 1 < argc && std::atof(argv[i + 1]) > 0) {
+			timeScale = std::atof(argv[++i]);
+		}
+	}
+	if (cork && !eventLoop) {
+		// each response is already a single write, there is nothing to coalesce
+		std::cout << "--cork only applies with --event-loop" << std::endl;
+	}
 
 	//initialize the memory
 	cpen333::process::shared_object<SharedData> memory(WAREHOUSE_MEMORY_NAME);
@@ -497,7 +816,8 @@ int main() {
 
 	//Make a warehouse and DA QUEUES
 	Warehouse warehouse;
-	PickupQueue pick;
+	SimClock clock(CLOCK_REAL_TIME, timeScale);
+	PickupQueue pick(clock, load_sla_classes("./data/sla.json"));
 	DeliveryCompQueue delivercomp; //from robot to computer
 	DeliveryTruckQueue delivertruck; //from computer to robot
 	RestockingQueue restock;
@@ -517,8 +837,6 @@ int main() {
 
 		//find all the shelves in the warehouse 
 		warehouse.findAllShelves(maze, memory->winfo);
-		//put products on the shelf!! (items) 
-		warehouse = load_warehouse("./data/inventory.json", warehouse);
 		//find start location of robots
 		warehouse.findStart(maze, memory->rinfo, memory->winfo);
 		ndocks = memory->winfo.docks.ndocks;
@@ -529,9 +847,30 @@ int main() {
 
 	
 	std::vector<Robot*> robots;
+	PathPlanner planner(memory->winfo, memory->rinfo);
+	ReservationTable reservations(planner, memory->rinfo, clock);
+
+	//put products on the shelf!! (items), fast movers closest to the start and exit
+	SlottingOptimizer slotting(planner, memory->rinfo);
+	warehouse = load_warehouse("./data/inventory.json", warehouse, slotting);
+
+	// distances between shelves, docks, start and exit, for every process
+	auto tableStart = std::chrono::steady_clock::now();
+	DistanceTable distances;
+	distances.build(planner, memory->winfo, memory->rinfo);
+	std::cout << "Distance table: " << distances.points() << " points, " << distances.bytes() / 1024 << " KB, built in "
+		<< std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - tableStart).count()
+		<< " ms" << std::endl;
+	RobotDispatcher dispatcher(pick, restock, delivertruck);
+	AssignmentEngine assignments(planner, memory->rinfo);
+	dispatcher.attach(assignments);
+
+	// pool handling client requests
+	WorkerPool workers(workerThreads, workerQueue);
 
 	// start server
 	cpen333::process::socket_server server(MUSIC_LIBRARY_SERVER_PORT);
+	server.set_no_delay(noDelay);
 	server.open();
 	std::cout << "Server started on port " << server.port() << std::endl;
 
@@ -539,7 +878,7 @@ int main() {
 	int clientCount = 1;
 
 	//open UI thread
-	std::thread userUI(warehouseUI, std::ref(robots), std::ref(inv), std::ref(orderList), std::ref(warehouse),std::ref(restock),std::ref(delivercomp), std::ref(delivertruck), std::ref(pick));
+	std::thread userUI(warehouseUI, std::ref(robots), std::ref(inv), std::ref(orderList), std::ref(warehouse), std::ref(planner), std::ref(reservations), std::ref(dispatcher), std::ref(delivercomp), std::ref(workers), std::ref(slotting));
 	
 
 	//thread that handles trucks
@@ -547,11 +886,42 @@ int main() {
 		std::ref(restock),std::ref(delivercomp), std::ref(delivertruck), ndocks);
 	
 	//listen for clients
-	while (server.accept(client)) {
+	if (eventLoop) {
+#ifdef __linux__
+		std::cout << "Servicing clients with " << reactorThreads << " event loop threads" << std::endl;
+		EventLoopServer reactors([&](std::unique_ptr<Message>&& msg, int id, EventLoopServer::Reply reply) {
+			if (msg->type() == MessageType::GOODBYE) {
+				handleMessage(inv, orderList, *msg, id, pick);
+				reply(nullptr);
+				return;
+			}
+			std::shared_ptr<Message> request(std::move(msg));
+			bool admitted = workers.trySubmit([&inv, &orderList, &pick, request, id, reply]() {
+				std::unique_ptr<Message> response;
+				try {
+					response = handleMessage(inv, orderList, *request, id, pick);
+				}
+				catch (std::exception& e) {
+					std::cout << "Client " << id << " request failed: " << e.what() << std::endl;
+					response = errorResponse(*request, e.what());
+				}
+				reply(std::move(response));
+			});
+			if (!admitted) {
+				std::cout << "Client " << id << " turned away, server busy" << std::endl;
+				reply(std::unique_ptr<Message>(new BusyResponseMessage()));
+			}
+		}, reactorThreads, cork);
+		reactors.run(server);
+#else
+		std::cout << "Event loop mode is only available on Linux" << std::endl;
+#endif
+	}
+	while (!eventLoop && server.accept(client)) {
 		// create API handler
 		JsonUserClientApi api(std::move(client));
 		// service client-server communication
-		std::thread thread(service, std::ref(inv), std::ref(orderList), std::move(api), clientCount, std::ref(pick));
+		std::thread thread(service, std::ref(inv), std::ref(orderList), std::move(api), clientCount, std::ref(pick), std::ref(workers));
 		thread.detach();
 		clientCount++;
 	}
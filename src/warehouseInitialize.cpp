@@ -16,11 +16,15 @@
 #include <cpen333/process/mutex.h>
 #include <cpen333/process/shared_memory.h>
 
-#include "TruckQueue.h"
 #include "Truck.h"
 
 #include "safe_printf.h"
 #include "Robot.h"
+#include "RobotDispatcher.h"
+#include "PathPlanner.h"
+#include "ReservationTable.h"
+#include "SlottingOptimizer.h"
+#include "DeliveryCompQueue.h"
 #include "Warehouse.h"
 #include "WarehouseCommon.h"
 #include "WarehouseInventory.h"
@@ -107,22 +111,19 @@ WarehouseInventory load_inventory(const std::string& filename) {
 /**
 * Loads items from a JSON file
 * @param filename file to load items from
+* @param slotting chooses the shelves items go on
 * @return warehouse 
 */
-Warehouse load_warehouse(const std::string& filename, Warehouse warehouse) {
+Warehouse load_warehouse(const std::string& filename, Warehouse warehouse, const SlottingOptimizer &slotting) {
 
 	std::ifstream fin(filename);
 	if (fin.is_open()) {
 		JSON j;
 		fin >> j;
 		std::vector<Item> items = JsonConverter::parseItems(j);
-
-		for (int i = 0; i < items.size(); i++) {
-			warehouse.Shelves[i].storeItem(items[i]);
-
-			if (i == warehouse.Shelves.size()-1) {
-				i = 0;
-			}
+		int unplaced = slotting.slot(warehouse, items);
+		if (unplaced > 0) {
+			std::cerr << unplaced << " items did not fit on the shelves" << std::endl;
 		}
 		return warehouse;
 	}
@@ -149,17 +150,23 @@ int main(int argc, char* argv[]) {
 
 	//make a warehouse 
 	Warehouse warehouse;
-	PickupQueue pick;
-//	DeliveryQueue deliver; 
-	//TruckQueue truck; 
+	SimClock clock;
+	PickupQueue pick(clock);
+	RestockingQueue restock;
+	DeliveryTruckQueue delivertruck;
+	DeliveryCompQueue delivercomp;
+	RobotDispatcher dispatcher(pick, restock, delivertruck);
 
 	//find all the shelves in the warehouse 
 	warehouse.findAllShelves(maze, memory->winfo);
 	//memory->winfo.Shelves = warehouse.Shelves;
-	//put products on the shelf!! (items) 
-	warehouse = load_warehouse("./data/inventory.json", warehouse); 
 	//find start location of robots
 	warehouse.findStart(maze, memory->rinfo, memory->winfo);
+	PathPlanner planner(memory->winfo, memory->rinfo);
+	//put products on the shelf!! (items), fast movers closest to the start and exit
+	SlottingOptimizer slotting(planner, memory->rinfo);
+	warehouse = load_warehouse("./data/inventory.json", warehouse, slotting);
+	ReservationTable reservations(planner, memory->rinfo, clock);
 
 	//initialize inventory (item entries)
 	WarehouseInventory inventory = load_inventory("./data/inventory.json"); 
@@ -172,7 +179,7 @@ int main(int argc, char* argv[]) {
 	{
 		memory->rinfo.nrobots = memory->rinfo.nrobots + 1; 
 		int id_ = memory->rinfo.nrobots;
-		robots.push_back(new Robot(id_, std::ref(warehouse), (pick)));
+		robots.push_back(new Robot(id_, std::ref(warehouse), planner, reservations, dispatcher, delivercomp));
 	}
 	
 	Order sampleOrder(10);